@@ -0,0 +1,227 @@
+#include <stdlib.h>
+#include <string.h>
+#include "xil_printf.h"
+#include "channelizer.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+typedef struct channelizer {
+    fft_t*            p_fft_inst;
+    int               num_channels;    // M, also the decimation
+    int               taps_per_branch; // P
+    short*            p_taps;          // prototype as is: tap j of branch p at j*M + p
+    complex_sample_t* p_hist;          // ring of P branch input vectors, M samples each
+    int               hist_head;       // slot of the newest vector
+    complex_sample_t* p_prev;          // last M input samples, feed branches 1..M-1
+    complex_sample_t* p_blocks[2];     // fft frames, alternated so the filter overlaps the dma
+    int               cur_block;
+} channelizer_t;
+
+// commutator. Branch p sees x[nM - p], so branch 0 takes the first sample of this
+// block and the others take the previous block in reverse
+static void push_block(channelizer_t* p_chan_inst, const complex_sample_t* din) {
+    int M = p_chan_inst->num_channels;
+
+    p_chan_inst->hist_head = (p_chan_inst->hist_head + 1) % p_chan_inst->taps_per_branch;
+    complex_sample_t* p_vec = &p_chan_inst->p_hist[p_chan_inst->hist_head * M];
+
+    p_vec[0] = din[0];
+    for (int p = 1; p < M; p++) {
+        p_vec[p] = p_chan_inst->p_prev[M - p];
+    }
+
+    memcpy(p_chan_inst->p_prev, din, sizeof(complex_sample_t)*M);
+}
+
+#ifndef __ARM_NEON
+static short sat_q15(int acc) {
+    acc = (acc + (1 << 14)) >> 15;
+    if (acc > 32767) {
+        return 32767;
+    } else if (acc < -32768) {
+        return -32768;
+    }
+    return (short)acc;
+}
+#endif
+
+// polyphase fir, one output per branch into the fft frame. Vectorised across
+// branches: for each tap the 8 branch taps and 8 history samples are contiguous
+static void filter_block(channelizer_t* p_chan_inst, complex_sample_t* dout) {
+    int M = p_chan_inst->num_channels;
+    int P = p_chan_inst->taps_per_branch;
+    const complex_sample_t* rows[CHANNELIZER_MAX_TAPS_PER_BRANCH];
+
+    // history vector feeding tap j, newest first
+    for (int j = 0; j < P; j++) {
+        rows[j] = &p_chan_inst->p_hist[((p_chan_inst->hist_head - j + P) % P) * M];
+    }
+
+    for (int p = 0; p < M; p += 8) {
+#ifdef __ARM_NEON
+        int32x4_t re_lo = vdupq_n_s32(0);
+        int32x4_t re_hi = vdupq_n_s32(0);
+        int32x4_t im_lo = vdupq_n_s32(0);
+        int32x4_t im_hi = vdupq_n_s32(0);
+
+        for (int j = 0; j < P; j++) {
+            int16x8_t   h = vld1q_s16(&p_chan_inst->p_taps[j*M + p]);
+            int16x8x2_t x = vld2q_s16((const int16_t*)&rows[j][p]);
+
+            re_lo = vmlal_s16(re_lo, vget_low_s16(x.val[0]),  vget_low_s16(h));
+            re_hi = vmlal_s16(re_hi, vget_high_s16(x.val[0]), vget_high_s16(h));
+            im_lo = vmlal_s16(im_lo, vget_low_s16(x.val[1]),  vget_low_s16(h));
+            im_hi = vmlal_s16(im_hi, vget_high_s16(x.val[1]), vget_high_s16(h));
+        }
+
+        int16x8x2_t y;
+        y.val[0] = vcombine_s16(vqrshrn_n_s32(re_lo, 15), vqrshrn_n_s32(re_hi, 15));
+        y.val[1] = vcombine_s16(vqrshrn_n_s32(im_lo, 15), vqrshrn_n_s32(im_hi, 15));
+        vst2q_s16((int16_t*)&dout[p], y);
+#else
+        int acc_re[8] = {0};
+        int acc_im[8] = {0};
+
+        for (int j = 0; j < P; j++) {
+            const short*            h = &p_chan_inst->p_taps[j*M + p];
+            const complex_sample_t* x = &rows[j][p];
+            for (int i = 0; i < 8; i++) {
+                acc_re[i] += h[i] * x[i].data_re;
+                acc_im[i] += h[i] * x[i].data_im;
+            }
+        }
+
+        for (int i = 0; i < 8; i++) {
+            dout[p + i].data_re = sat_q15(acc_re[i]);
+            dout[p + i].data_im = sat_q15(acc_im[i]);
+        }
+#endif
+    }
+}
+
+// fft bin k of a block is sample n of channel k
+static void scatter_block(channelizer_t* p_chan_inst, const complex_sample_t* p_block, complex_sample_t* const* ch_out, int n) {
+    for (int k = 0; k < p_chan_inst->num_channels; k++) {
+        ch_out[k][n] = p_block[k];
+    }
+}
+
+// Public functions
+channelizer_t* channelizer_create(fft_t* p_fft_inst, int num_channels, int taps_per_branch, const short* p_taps) {
+
+    if ((num_channels < CHANNELIZER_MIN_CHANNELS) || (num_channels % CHANNELIZER_MIN_CHANNELS != 0) ||
+        (num_channels > FFT_MAX_NUM_PTS) || (taps_per_branch < 1) ||
+        (taps_per_branch > CHANNELIZER_MAX_TAPS_PER_BRANCH) || (p_taps == NULL)) {
+        xil_printf("ERROR! Illegal channelizer parameters.\n\r");
+        return NULL;
+    }
+
+    channelizer_t* p_obj = (channelizer_t*) calloc(1, sizeof(channelizer_t));
+    if (p_obj == NULL) {
+        xil_printf("ERROR! Failed to allocate memory for channelizer object.\n\r");
+        return NULL;
+    }
+
+    p_obj->p_fft_inst      = p_fft_inst;
+    p_obj->num_channels    = num_channels;
+    p_obj->taps_per_branch = taps_per_branch;
+
+    p_obj->p_taps      = (short*) malloc(sizeof(short)*num_channels*taps_per_branch);
+    p_obj->p_hist      = (complex_sample_t*) malloc(sizeof(complex_sample_t)*num_channels*taps_per_branch);
+    p_obj->p_prev      = (complex_sample_t*) malloc(sizeof(complex_sample_t)*num_channels);
+    p_obj->p_blocks[0] = (complex_sample_t*) dma_accel_alloc_buf(sizeof(complex_sample_t)*num_channels);
+    p_obj->p_blocks[1] = (complex_sample_t*) dma_accel_alloc_buf(sizeof(complex_sample_t)*num_channels);
+
+    if ((p_obj->p_taps == NULL) || (p_obj->p_hist == NULL) || (p_obj->p_prev == NULL) ||
+        (p_obj->p_blocks[0] == NULL) || (p_obj->p_blocks[1] == NULL)) {
+        xil_printf("ERROR! Failed to allocate memory for channelizer buffers.\n\r");
+        channelizer_destroy(p_obj);
+        return NULL;
+    }
+
+    // only touch the caller's engine once nothing else can fail
+    if (fft_set_num_pts(p_fft_inst, num_channels) != FFT_SUCCESS) {
+        xil_printf("ERROR! The FFT engine can't run a %d-point transform for the channelizer.\n\r", num_channels);
+        channelizer_destroy(p_obj);
+        return NULL;
+    }
+
+    memcpy(p_obj->p_taps, p_taps, sizeof(short)*num_channels*taps_per_branch);
+    channelizer_reset(p_obj);
+
+    return p_obj;
+
+}
+
+void channelizer_destroy(channelizer_t* p_chan_inst) {
+    free(p_chan_inst->p_taps);
+    free(p_chan_inst->p_hist);
+    free(p_chan_inst->p_prev);
+    dma_accel_free_buf(p_chan_inst->p_blocks[0]);
+    dma_accel_free_buf(p_chan_inst->p_blocks[1]);
+    free(p_chan_inst);
+}
+
+void channelizer_reset(channelizer_t* p_chan_inst) {
+    memset(p_chan_inst->p_hist, 0, sizeof(complex_sample_t)*p_chan_inst->num_channels*p_chan_inst->taps_per_branch);
+    memset(p_chan_inst->p_prev, 0, sizeof(complex_sample_t)*p_chan_inst->num_channels);
+    p_chan_inst->hist_head = 0;
+    p_chan_inst->cur_block = 0;
+}
+
+int channelizer_get_num_channels(channelizer_t* p_chan_inst) {
+    return (p_chan_inst->num_channels);
+}
+
+int channelizer_get_scale_shift(channelizer_t* p_chan_inst) {
+    return fft_get_scale_shift(p_chan_inst->p_fft_inst);
+}
+
+int channelizer_process(channelizer_t* p_chan_inst, const complex_sample_t* din, int num_samples, complex_sample_t* const* ch_out) {
+
+    int M = p_chan_inst->num_channels;
+
+    if ((num_samples < 0) || (num_samples % M != 0)) {
+        xil_printf("ERROR! Channelizer input must be a multiple of %d samples.\n\r", M);
+        return CHANNELIZER_ILLEGAL_PARAMS;
+    }
+
+    // the engine may have been used for something else since the last call
+    if (fft_ensure_config(p_chan_inst->p_fft_inst, M, FFT_INVERSE) != FFT_SUCCESS) {
+        return CHANNELIZER_FFT_FAIL;
+    }
+
+    int num_blocks = num_samples / M;
+
+    for (int n = 0; n < num_blocks; n++) {
+        complex_sample_t* p_block = p_chan_inst->p_blocks[p_chan_inst->cur_block];
+
+        // filter this block while the engine transforms the previous one
+        push_block(p_chan_inst, &din[n*M]);
+        filter_block(p_chan_inst, p_block);
+
+        if (n > 0) {
+            if (fft_wait(p_chan_inst->p_fft_inst) != FFT_SUCCESS) {
+                return CHANNELIZER_FFT_FAIL;
+            }
+            scatter_block(p_chan_inst, p_chan_inst->p_blocks[p_chan_inst->cur_block ^ 1], ch_out, n - 1);
+        }
+
+        fft_set_queue_depth(p_chan_inst->p_fft_inst, num_blocks - n - 1);
+        if (fft_start(p_chan_inst->p_fft_inst, p_block, p_block) != FFT_SUCCESS) {
+            return CHANNELIZER_FFT_FAIL;
+        }
+
+        p_chan_inst->cur_block ^= 1;
+    }
+
+    if (num_blocks > 0) {
+        if (fft_wait(p_chan_inst->p_fft_inst) != FFT_SUCCESS) {
+            return CHANNELIZER_FFT_FAIL;
+        }
+        scatter_block(p_chan_inst, p_chan_inst->p_blocks[p_chan_inst->cur_block ^ 1], ch_out, num_blocks - 1);
+    }
+
+    return CHANNELIZER_SUCCESS;
+}
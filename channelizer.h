@@ -0,0 +1,43 @@
+#ifndef CHANNELIZER_H
+#define CHANNELIZER_H
+
+#include "complex_sample.h"
+#include "fft.h"
+
+#define CHANNELIZER_SUCCESS          0
+#define CHANNELIZER_ILLEGAL_PARAMS  -1
+#define CHANNELIZER_ALLOC_FAIL      -2
+#define CHANNELIZER_FFT_FAIL        -3
+
+// branches are filtered 8 at a time, so the channel count must be a multiple of this
+#define CHANNELIZER_MIN_CHANNELS     8
+#define CHANNELIZER_MAX_TAPS_PER_BRANCH 64
+
+typedef struct channelizer channelizer_t;
+
+// critically sampled polyphase analysis bank: splits the input into num_channels
+// channels, each decimated by num_channels. Channel k is centred on k/num_channels
+// of the input rate (upper half are negative frequencies).
+//
+// p_taps is the prototype lowpass h[0 .. num_channels*taps_per_branch-1] in Q15.
+// Branch p filters with h[p], h[p + M], h[p + 2M], ... so keep the magnitude of
+// each branch's taps summing to at most 1.0 or the filter output saturates.
+// The channelizer drives p_fft_inst as an inverse num_channels-point transform
+channelizer_t* channelizer_create(fft_t* p_fft_inst, int num_channels, int taps_per_branch, const short* p_taps);
+
+void channelizer_destroy(channelizer_t* p_chan_inst);
+
+// clear the filter history, as if the stream started over
+void channelizer_reset(channelizer_t* p_chan_inst);
+
+int channelizer_get_num_channels(channelizer_t* p_chan_inst);
+
+// outputs are scaled down by 2^shift by the fft scale schedule
+int channelizer_get_scale_shift(channelizer_t* p_chan_inst);
+
+// run num_samples input samples (a multiple of num_channels) through the bank.
+// Channel k's num_samples/num_channels outputs are written to ch_out[k].
+// The filter history carries over between calls
+int channelizer_process(channelizer_t* p_chan_inst, const complex_sample_t* din, int num_samples, complex_sample_t* const* ch_out);
+
+#endif // CHANNELIZER_H
@@ -0,0 +1,51 @@
+#include "completion_ring.h"
+
+// head and tail are free running, the index is taken modulo the ring size
+#define RING_MASK (COMPLETION_RING_SIZE - 1)
+
+void completion_ring_init(completion_ring_t* p_ring) {
+    p_ring->head    = 0;
+    p_ring->tail    = 0;
+    p_ring->dropped = 0;
+}
+
+int completion_ring_push(completion_ring_t* p_ring, const completion_entry_t* p_entry) {
+
+    unsigned int head = p_ring->head;
+    unsigned int tail = __atomic_load_n(&p_ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail >= COMPLETION_RING_SIZE) {
+        p_ring->dropped++;
+        return 0;
+    }
+
+    p_ring->entries[head & RING_MASK] = *p_entry;
+
+    // publish the entry only after its contents are visible
+    __atomic_store_n(&p_ring->head, head + 1, __ATOMIC_RELEASE);
+
+    return 1;
+
+}
+
+int completion_ring_pop(completion_ring_t* p_ring, completion_entry_t* p_entries, int max_entries) {
+
+    unsigned int tail = p_ring->tail;
+    unsigned int head = __atomic_load_n(&p_ring->head, __ATOMIC_ACQUIRE);
+    int          n    = 0;
+
+    while ((tail != head) && (n < max_entries)) {
+        p_entries[n++] = p_ring->entries[tail & RING_MASK];
+        tail++;
+    }
+
+    // hand the slots back to the producer
+    __atomic_store_n(&p_ring->tail, tail, __ATOMIC_RELEASE);
+
+    return n;
+
+}
+
+int completion_ring_count(completion_ring_t* p_ring) {
+    return (int)(__atomic_load_n(&p_ring->head, __ATOMIC_ACQUIRE) - p_ring->tail);
+}
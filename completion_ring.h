@@ -0,0 +1,37 @@
+#ifndef COMPLETION_RING_H
+#define COMPLETION_RING_H
+
+// number of entries, must be a power of 2
+#define COMPLETION_RING_SIZE 64
+
+// one finished dma channel transfer
+typedef struct completion_entry
+{
+    unsigned int       id;        // transfer id handed out at submit time
+    int                channel;   // DMA_ACCEL_CHANNEL_MM2S or DMA_ACCEL_CHANNEL_S2MM
+    int                status;    // DMA_ACCEL_SUCCESS or DMA_ACCEL_TRANSFER_FAIL
+    int                num_bytes;
+    unsigned long long timestamp; // global timer ticks when the completion was seen
+} completion_entry_t;
+
+// lock-free single-producer/single-consumer ring. The producer is the dma
+// interrupt context (or the poller in polled mode), the consumer is the application.
+typedef struct completion_ring
+{
+    unsigned int       head;      // written by the producer only
+    unsigned int       tail;      // written by the consumer only
+    unsigned int       dropped;   // entries lost because the ring was full
+    completion_entry_t entries[COMPLETION_RING_SIZE];
+} completion_ring_t;
+
+void completion_ring_init(completion_ring_t* p_ring);
+
+// producer side. Returns 0 and counts a drop if the ring is full
+int completion_ring_push(completion_ring_t* p_ring, const completion_entry_t* p_entry);
+
+// consumer side. Copies up to max_entries entries out, returns how many
+int completion_ring_pop(completion_ring_t* p_ring, completion_entry_t* p_entries, int max_entries);
+
+int completion_ring_count(completion_ring_t* p_ring);
+
+#endif // COMPLETION_RING_H
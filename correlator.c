@@ -0,0 +1,338 @@
+#include <stdlib.h>
+#include <string.h>
+#include "xil_printf.h"
+#include "correlator.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+typedef struct correlator {
+    fft_t*            p_fft_inst;
+    int               num_pts;
+    int               num_templates;
+    complex_sample_t* p_templates[CORRELATOR_MAX_TEMPLATES];  // conjugated spectra, scaled to full range
+    int               template_exp[CORRELATOR_MAX_TEMPLATES]; // left shift that scaling took
+    complex_sample_t* p_spec;                                 // spectrum of the current frame
+    complex_sample_t* p_bufs[2];                              // products, inverse transformed in place
+} correlator_t;
+
+#ifdef __ARM_NEON
+static const uint32_t g_lane_idx[4] = {0, 1, 2, 3};
+#endif
+
+static short sat_16(long long x) {
+    if (x > 32767) {
+        return 32767;
+    } else if (x < -32768) {
+        return -32768;
+    }
+    return (short)x;
+}
+
+// left shift every component of p_data takes without overflowing. x ^ (x >> 15)
+// has the bit length of the magnitude for either sign, the widest sets it
+static int headroom(const complex_sample_t* p_data, int num_pts) {
+    const short* p_src = (const short*)p_data;
+    int          n     = 2*num_pts;
+    int          i     = 0;
+    unsigned int bits  = 0;
+
+#ifdef __ARM_NEON
+    int16x8_t acc = vdupq_n_s16(0);
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t x = vld1q_s16(&p_src[i]);
+        acc = vorrq_s16(acc, veorq_s16(x, vshrq_n_s16(x, 15)));
+    }
+
+    short lanes[8];
+    vst1q_s16(lanes, acc);
+    for (int l = 0; l < 8; l++) {
+        bits |= (unsigned short)lanes[l];
+    }
+#endif
+
+    for (; i < n; i++) {
+        bits |= (unsigned short)(p_src[i] ^ (p_src[i] >> 15));
+    }
+
+    int width = (bits == 0) ? 15 : 32 - __builtin_clz(bits);
+    return 15 - width;
+}
+
+// dout = (spec * conj(T)) >> shift. The template is stored conjugated, so a
+// plain complex multiply: (a + jb)(c + jd) = (ac - bd) + j(ad + bc)
+static void multiply(correlator_t* p_corr_inst, const complex_sample_t* p_tmpl, int shift, complex_sample_t* dout) {
+    const complex_sample_t* p_spec = p_corr_inst->p_spec;
+    int                     k      = 0;
+
+#ifdef __ARM_NEON
+    // vrshl by a negative amount is a rounding right shift
+    int32x4_t v_shift = vdupq_n_s32(-shift);
+
+    for (; k + 8 <= p_corr_inst->num_pts; k += 8) {
+        int16x8x2_t x = vld2q_s16((const int16_t*)&p_spec[k]);
+        int16x8x2_t t = vld2q_s16((const int16_t*)&p_tmpl[k]);
+
+        int16x4_t a_lo = vget_low_s16(x.val[0]), a_hi = vget_high_s16(x.val[0]);
+        int16x4_t b_lo = vget_low_s16(x.val[1]), b_hi = vget_high_s16(x.val[1]);
+        int16x4_t c_lo = vget_low_s16(t.val[0]), c_hi = vget_high_s16(t.val[0]);
+        int16x4_t d_lo = vget_low_s16(t.val[1]), d_hi = vget_high_s16(t.val[1]);
+
+        int32x4_t re_lo = vrshlq_s32(vmlsl_s16(vmull_s16(a_lo, c_lo), b_lo, d_lo), v_shift);
+        int32x4_t re_hi = vrshlq_s32(vmlsl_s16(vmull_s16(a_hi, c_hi), b_hi, d_hi), v_shift);
+        int32x4_t im_lo = vrshlq_s32(vmlal_s16(vmull_s16(a_lo, d_lo), b_lo, c_lo), v_shift);
+        int32x4_t im_hi = vrshlq_s32(vmlal_s16(vmull_s16(a_hi, d_hi), b_hi, c_hi), v_shift);
+
+        int16x8x2_t y;
+        y.val[0] = vcombine_s16(vqmovn_s32(re_lo), vqmovn_s32(re_hi));
+        y.val[1] = vcombine_s16(vqmovn_s32(im_lo), vqmovn_s32(im_hi));
+        vst2q_s16((int16_t*)&dout[k], y);
+    }
+#endif
+
+    int half = (shift > 0) ? (1 << (shift - 1)) : 0;
+
+    for (; k < p_corr_inst->num_pts; k++) {
+        long long re = (long long)p_spec[k].data_re*p_tmpl[k].data_re - (long long)p_spec[k].data_im*p_tmpl[k].data_im;
+        long long im = (long long)p_spec[k].data_re*p_tmpl[k].data_im + (long long)p_spec[k].data_im*p_tmpl[k].data_re;
+
+        dout[k].data_re = sat_16((re + half) >> shift);
+        dout[k].data_im = sat_16((im + half) >> shift);
+    }
+}
+
+// argmax of |r|^2 and the total power in one pass over the inverse output.
+// Each lane keeps its own max and where it was, merged at the end
+static void find_peak(correlator_t* p_corr_inst, const complex_sample_t* p_corr, int block_exp, correlator_result_t* p_result) {
+    int                n     = p_corr_inst->num_pts;
+    unsigned int       peak  = 0;
+    int                lag   = 0;
+    unsigned long long total = 0;
+    int                k     = 0;
+
+#ifdef __ARM_NEON
+    uint32x4_t v_max  = vdupq_n_u32(0);
+    uint32x4_t v_lag  = vdupq_n_u32(0);
+    uint32x4_t v_k    = vld1q_u32(g_lane_idx);
+    uint32x4_t v_four = vdupq_n_u32(4);
+    uint64x2_t v_sum  = vdupq_n_u64(0);
+
+    for (; k + 8 <= n; k += 8) {
+        int16x8x2_t x = vld2q_s16((const int16_t*)&p_corr[k]);
+
+        // 2^31 wraps the signed accumulator but is right read as unsigned
+        uint32x4_t lo = vreinterpretq_u32_s32(vmlal_s16(vmull_s16(vget_low_s16(x.val[0]),  vget_low_s16(x.val[0])),
+                                                        vget_low_s16(x.val[1]),  vget_low_s16(x.val[1])));
+        uint32x4_t hi = vreinterpretq_u32_s32(vmlal_s16(vmull_s16(vget_high_s16(x.val[0]), vget_high_s16(x.val[0])),
+                                                        vget_high_s16(x.val[1]), vget_high_s16(x.val[1])));
+
+        uint32x4_t m = vcgtq_u32(lo, v_max);
+        v_max = vbslq_u32(m, lo, v_max);
+        v_lag = vbslq_u32(m, v_k, v_lag);
+        v_k   = vaddq_u32(v_k, v_four);
+
+        m     = vcgtq_u32(hi, v_max);
+        v_max = vbslq_u32(m, hi, v_max);
+        v_lag = vbslq_u32(m, v_k, v_lag);
+        v_k   = vaddq_u32(v_k, v_four);
+
+        v_sum = vpadalq_u32(v_sum, lo);
+        v_sum = vpadalq_u32(v_sum, hi);
+    }
+
+    unsigned int lane_max[4];
+    unsigned int lane_lag[4];
+    vst1q_u32(lane_max, v_max);
+    vst1q_u32(lane_lag, v_lag);
+
+    // on a tie the earliest lag wins, as in the scalar loop
+    for (int i = 0; i < 4; i++) {
+        if ((lane_max[i] > peak) || ((lane_max[i] == peak) && ((int)lane_lag[i] < lag))) {
+            peak = lane_max[i];
+            lag  = lane_lag[i];
+        }
+    }
+    total = vgetq_lane_u64(v_sum, 0) + vgetq_lane_u64(v_sum, 1);
+#endif
+
+    for (; k < n; k++) {
+        unsigned int mag = (unsigned int)(p_corr[k].data_re*p_corr[k].data_re) + (unsigned int)(p_corr[k].data_im*p_corr[k].data_im);
+        if (mag > peak) {
+            peak = mag;
+            lag  = k;
+        }
+        total += mag;
+    }
+
+    unsigned long long rest = total - peak;
+
+    p_result->lag       = lag;
+    p_result->peak      = peak;
+    p_result->block_exp = block_exp;
+    p_result->snr       = (float)peak*(float)(n - 1) / (float)((rest > 0) ? rest : 1);
+}
+
+// Public functions
+correlator_t* correlator_create(fft_t* p_fft_inst, int num_pts) {
+
+    if ((num_pts < FFT_MIN_NUM_PTS) || (num_pts > FFT_MAX_NUM_PTS)) {
+        xil_printf("ERROR! Illegal correlator size %d.\n\r", num_pts);
+        return NULL;
+    }
+
+    correlator_t* p_obj = (correlator_t*) calloc(1, sizeof(correlator_t));
+    if (p_obj == NULL) {
+        xil_printf("ERROR! Failed to allocate memory for correlator object.\n\r");
+        return NULL;
+    }
+
+    p_obj->p_fft_inst = p_fft_inst;
+    p_obj->num_pts    = num_pts;
+
+    p_obj->p_spec    = (complex_sample_t*) dma_accel_alloc_buf(sizeof(complex_sample_t)*num_pts);
+    p_obj->p_bufs[0] = (complex_sample_t*) dma_accel_alloc_buf(sizeof(complex_sample_t)*num_pts);
+    p_obj->p_bufs[1] = (complex_sample_t*) dma_accel_alloc_buf(sizeof(complex_sample_t)*num_pts);
+
+    if ((p_obj->p_spec == NULL) || (p_obj->p_bufs[0] == NULL) || (p_obj->p_bufs[1] == NULL)) {
+        xil_printf("ERROR! Failed to allocate memory for correlator buffers.\n\r");
+        correlator_destroy(p_obj);
+        return NULL;
+    }
+
+    // only touch the caller's engine once nothing else can fail
+    if (fft_set_num_pts(p_fft_inst, num_pts) != FFT_SUCCESS) {
+        xil_printf("ERROR! The FFT engine can't run a %d-point transform for the correlator.\n\r", num_pts);
+        correlator_destroy(p_obj);
+        return NULL;
+    }
+
+    return p_obj;
+
+}
+
+void correlator_destroy(correlator_t* p_corr_inst) {
+    correlator_clear_templates(p_corr_inst);
+    dma_accel_free_buf(p_corr_inst->p_spec);
+    dma_accel_free_buf(p_corr_inst->p_bufs[0]);
+    dma_accel_free_buf(p_corr_inst->p_bufs[1]);
+    free(p_corr_inst);
+}
+
+int correlator_add_template(correlator_t* p_corr_inst, const complex_sample_t* p_template, int num_samples) {
+
+    int n = p_corr_inst->num_pts;
+
+    if ((p_template == NULL) || (num_samples < 1) || (num_samples > n)) {
+        xil_printf("ERROR! A correlator template must have 1 to %d samples.\n\r", n);
+        return CORRELATOR_ILLEGAL_PARAMS;
+    }
+
+    if (p_corr_inst->num_templates == CORRELATOR_MAX_TEMPLATES) {
+        xil_printf("ERROR! The correlator already has %d templates.\n\r", CORRELATOR_MAX_TEMPLATES);
+        return CORRELATOR_FULL;
+    }
+
+    if (fft_ensure_config(p_corr_inst->p_fft_inst, n, FFT_FORWARD) != FFT_SUCCESS) {
+        return CORRELATOR_FFT_FAIL;
+    }
+
+    complex_sample_t* p_tmpl = (complex_sample_t*) malloc(sizeof(complex_sample_t)*n);
+    if (p_tmpl == NULL) {
+        xil_printf("ERROR! Failed to allocate memory for correlator template.\n\r");
+        return CORRELATOR_ALLOC_FAIL;
+    }
+
+    // zero padded, transformed in place in a frame buffer
+    complex_sample_t* p_frame = p_corr_inst->p_bufs[0];
+    memset(p_frame, 0, sizeof(complex_sample_t)*n);
+    memcpy(p_frame, p_template, sizeof(complex_sample_t)*num_samples);
+
+    fft_set_queue_depth(p_corr_inst->p_fft_inst, 0);
+    if (fft(p_corr_inst->p_fft_inst, p_frame, p_frame) != FFT_SUCCESS) {
+        free(p_tmpl);
+        return CORRELATOR_FFT_FAIL;
+    }
+
+    // a scaled transform of a short pulse only uses the low bits. Scale it up
+    // to full range once here, so the products keep their precision
+    int exp = headroom(p_frame, n);
+
+    for (int k = 0; k < n; k++) {
+        p_tmpl[k].data_re = sat_16((long long)p_frame[k].data_re << exp);
+        p_tmpl[k].data_im = sat_16(-((long long)p_frame[k].data_im << exp));
+    }
+
+    p_corr_inst->p_templates[p_corr_inst->num_templates]  = p_tmpl;
+    p_corr_inst->template_exp[p_corr_inst->num_templates] = exp;
+    return p_corr_inst->num_templates++;
+
+}
+
+void correlator_clear_templates(correlator_t* p_corr_inst) {
+    for (int t = 0; t < p_corr_inst->num_templates; t++) {
+        free(p_corr_inst->p_templates[t]);
+        p_corr_inst->p_templates[t] = NULL;
+    }
+    p_corr_inst->num_templates = 0;
+}
+
+int correlator_get_num_templates(correlator_t* p_corr_inst) {
+    return (p_corr_inst->num_templates);
+}
+
+int correlator_process(correlator_t* p_corr_inst, const complex_sample_t* din, correlator_result_t* p_results) {
+
+    int num_templates = p_corr_inst->num_templates;
+
+    if (num_templates == 0) {
+        return CORRELATOR_SUCCESS;
+    }
+
+    // the engine may have been used for something else since the last call
+    if (fft_ensure_config(p_corr_inst->p_fft_inst, p_corr_inst->num_pts, FFT_FORWARD) != FFT_SUCCESS) {
+        return CORRELATOR_FFT_FAIL;
+    }
+    fft_set_queue_depth(p_corr_inst->p_fft_inst, num_templates);
+    if (fft(p_corr_inst->p_fft_inst, (complex_sample_t*)din, p_corr_inst->p_spec) != FFT_SUCCESS) {
+        return CORRELATOR_FFT_FAIL;
+    }
+
+    fft_set_fwd_inv(p_corr_inst->p_fft_inst, FFT_INVERSE);
+
+    // the frame spectrum is scaled up the same way, folded into the product
+    // shift. One bit more keeps |spec * T| <= 1 from saturating
+    int spec_exp = headroom(p_corr_inst->p_spec, p_corr_inst->num_pts);
+    int shift    = 16 - spec_exp;
+
+    // template t is multiplied while the engine runs t-1, and t-1 is searched
+    // while it runs t. Two buffers are enough: t reuses the one t-2 was searched in
+    for (int t = 0; t < num_templates; t++) {
+        complex_sample_t* p_buf = p_corr_inst->p_bufs[t & 1];
+
+        multiply(p_corr_inst, p_corr_inst->p_templates[t], shift, p_buf);
+
+        if (t > 0) {
+            if (fft_wait(p_corr_inst->p_fft_inst) != FFT_SUCCESS) {
+                return CORRELATOR_FFT_FAIL;
+            }
+        }
+
+        fft_set_queue_depth(p_corr_inst->p_fft_inst, num_templates - t - 1);
+        if (fft_start(p_corr_inst->p_fft_inst, p_buf, p_buf) != FFT_SUCCESS) {
+            return CORRELATOR_FFT_FAIL;
+        }
+
+        if (t > 0) {
+            find_peak(p_corr_inst, p_corr_inst->p_bufs[(t - 1) & 1], spec_exp + p_corr_inst->template_exp[t - 1] - 1,
+                      &p_results[t - 1]);
+        }
+    }
+
+    if (fft_wait(p_corr_inst->p_fft_inst) != FFT_SUCCESS) {
+        return CORRELATOR_FFT_FAIL;
+    }
+    find_peak(p_corr_inst, p_corr_inst->p_bufs[(num_templates - 1) & 1],
+              spec_exp + p_corr_inst->template_exp[num_templates - 1] - 1, &p_results[num_templates - 1]);
+
+    return CORRELATOR_SUCCESS;
+}
@@ -0,0 +1,49 @@
+#ifndef CORRELATOR_H
+#define CORRELATOR_H
+
+#include "complex_sample.h"
+#include "fft.h"
+
+#define CORRELATOR_SUCCESS         0
+#define CORRELATOR_ILLEGAL_PARAMS -1
+#define CORRELATOR_FFT_FAIL       -2
+#define CORRELATOR_FULL           -3
+#define CORRELATOR_ALLOC_FAIL     -4
+
+#define CORRELATOR_MAX_TEMPLATES   16
+
+// Matched filter bank on an fft engine. Each template's spectrum is taken once
+// when it's added and kept conjugated. Both spectra are block scaled to full
+// range before they're multiplied, so short templates don't vanish in the
+// engine's scaling. A frame then costs one forward transform
+// plus one inverse per template, run back to back on the engine: the product
+// for the next template and the peak search of the previous one are done while
+// the engine transforms the current one, and the correlation itself is never
+// copied out.
+
+typedef struct correlator_result
+{
+    int          lag;       // samples into the frame where the template starts, circularly
+    unsigned int peak;      // |r|^2 at lag
+    int          block_exp; // r came out 2^block_exp larger than unscaled spectra would give
+    float        snr;       // peak over the mean |r|^2 of every other lag
+} correlator_result_t;
+
+typedef struct correlator correlator_t;
+
+correlator_t* correlator_create(fft_t* p_fft_inst, int num_pts);
+
+void correlator_destroy(correlator_t* p_corr_inst);
+
+// template of up to num_pts samples, zero padded. Returns its index, which is
+// also where its result goes, or an error
+int correlator_add_template(correlator_t* p_corr_inst, const complex_sample_t* p_template, int num_samples);
+
+void correlator_clear_templates(correlator_t* p_corr_inst);
+
+int correlator_get_num_templates(correlator_t* p_corr_inst);
+
+// correlate num_pts samples of din against every template, one result each
+int correlator_process(correlator_t* p_corr_inst, const complex_sample_t* din, correlator_result_t* p_results);
+
+#endif // CORRELATOR_H
@@ -0,0 +1,326 @@
+#include <stdlib.h>
+#include <string.h>
+#include "xil_printf.h"
+#include "detector.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+typedef struct detector {
+    int                  num_pts;
+    detector_config_t    config;
+    unsigned int         cfar_scale_q8;
+    unsigned int*        p_mag;          // |X|^2 of every bin, cfar only
+    detection_record_t   records[DETECTOR_MAX_RECORDS];
+    int                  num_records;
+    complex_sample_t*    p_hist;         // ring of pre_trigger spectra
+    unsigned int         hist_ids[DETECTOR_MAX_PRE_TRIGGER];
+    int                  hist_head;      // next slot to write
+    int                  hist_count;
+    int                  post_remaining; // frames still to forward after the last trigger
+    detector_record_fn   record_fn;
+    void*                p_record_ctx;
+    detector_spectrum_fn spectrum_fn;
+    void*                p_spectrum_ctx;
+    detector_stats_t     stats;
+} detector_t;
+
+// can't overflow: the worst case is 2*(-32768)^2 = 2^31
+static unsigned int mag_sq(complex_sample_t x) {
+    return (unsigned int)(x.data_re*x.data_re) + (unsigned int)(x.data_im*x.data_im);
+}
+
+static void add_record(detector_t* p_det_inst, unsigned int frame_id, int bin, unsigned int mag) {
+    if (p_det_inst->num_records < DETECTOR_MAX_RECORDS) {
+        detection_record_t* p_rec = &p_det_inst->records[p_det_inst->num_records++];
+        p_rec->frame_id  = frame_id;
+        p_rec->bin       = (unsigned short)bin;
+        p_rec->reserved  = 0;
+        p_rec->magnitude = mag;
+    } else {
+        p_det_inst->stats.records_dropped++;
+    }
+}
+
+// magnitude and compare in registers. Nothing is stored unless one of the 8
+// bins crosses, which on a quiet frame is never
+static int scan_threshold(detector_t* p_det_inst, const complex_sample_t* p_spectrum, unsigned int frame_id) {
+    unsigned int thr        = p_det_inst->config.threshold;
+    int          detections = 0;
+    int          k          = 0;
+
+#ifdef __ARM_NEON
+    uint32x4_t v_thr = vdupq_n_u32(thr);
+
+    for (; k + 8 <= p_det_inst->num_pts; k += 8) {
+        int16x8x2_t x = vld2q_s16((const int16_t*)&p_spectrum[k]);
+
+        // 2^31 wraps the signed accumulator but is right read as unsigned
+        uint32x4_t lo = vreinterpretq_u32_s32(vmlal_s16(vmull_s16(vget_low_s16(x.val[0]),  vget_low_s16(x.val[0])),
+                                                        vget_low_s16(x.val[1]),  vget_low_s16(x.val[1])));
+        uint32x4_t hi = vreinterpretq_u32_s32(vmlal_s16(vmull_s16(vget_high_s16(x.val[0]), vget_high_s16(x.val[0])),
+                                                        vget_high_s16(x.val[1]), vget_high_s16(x.val[1])));
+
+        uint32x4_t any = vorrq_u32(vcgtq_u32(lo, v_thr), vcgtq_u32(hi, v_thr));
+        uint32x2_t red = vorr_u32(vget_low_u32(any), vget_high_u32(any));
+        if ((vget_lane_u32(red, 0) | vget_lane_u32(red, 1)) == 0) {
+            continue;
+        }
+
+        unsigned int mag[8];
+        vst1q_u32(&mag[0], lo);
+        vst1q_u32(&mag[4], hi);
+        for (int i = 0; i < 8; i++) {
+            if (mag[i] > thr) {
+                add_record(p_det_inst, frame_id, k + i, mag[i]);
+                detections++;
+            }
+        }
+    }
+#endif
+
+    for (; k < p_det_inst->num_pts; k++) {
+        unsigned int mag = mag_sq(p_spectrum[k]);
+        if (mag > thr) {
+            add_record(p_det_inst, frame_id, k, mag);
+            detections++;
+        }
+    }
+
+    return detections;
+}
+
+static void compute_mag(detector_t* p_det_inst, const complex_sample_t* p_spectrum) {
+    unsigned int* p_mag = p_det_inst->p_mag;
+    int           k     = 0;
+
+#ifdef __ARM_NEON
+    for (; k + 8 <= p_det_inst->num_pts; k += 8) {
+        int16x8x2_t x = vld2q_s16((const int16_t*)&p_spectrum[k]);
+
+        vst1q_u32(&p_mag[k],     vreinterpretq_u32_s32(vmlal_s16(vmull_s16(vget_low_s16(x.val[0]),  vget_low_s16(x.val[0])),
+                                                                 vget_low_s16(x.val[1]),  vget_low_s16(x.val[1]))));
+        vst1q_u32(&p_mag[k + 4], vreinterpretq_u32_s32(vmlal_s16(vmull_s16(vget_high_s16(x.val[0]), vget_high_s16(x.val[0])),
+                                                                 vget_high_s16(x.val[1]), vget_high_s16(x.val[1]))));
+    }
+#endif
+
+    for (; k < p_det_inst->num_pts; k++) {
+        p_mag[k] = mag_sq(p_spectrum[k]);
+    }
+}
+
+// cell averaging cfar over the circular spectrum. The two training windows slide
+// one bin per step, so each bin costs four adds whatever the window size. That
+// running sum is a serial chain, so the compare is fused into it rather than
+// vectorised: mag > scale*sum/num_train, in integers as
+// mag*num_train*256 > sum*scale_q8
+static int scan_cfar(detector_t* p_det_inst, const complex_sample_t* p_spectrum, unsigned int frame_id) {
+    int                 n          = p_det_inst->num_pts;
+    int                 G          = p_det_inst->config.guard_cells;
+    int                 T          = p_det_inst->config.train_cells;
+    unsigned int        thr        = p_det_inst->config.threshold;
+    unsigned long long  num_train  = 2*T;
+    unsigned long long  scale_q8   = p_det_inst->cfar_scale_q8;
+    const unsigned int* p_mag      = p_det_inst->p_mag;
+    unsigned long long  sum        = 0;
+    int                 detections = 0;
+
+    compute_mag(p_det_inst, p_spectrum);
+
+    // windows around bin 0
+    for (int j = G + 1; j <= G + T; j++) {
+        sum += p_mag[j % n];
+        sum += p_mag[(n - j % n) % n];
+    }
+
+    for (int k = 0; k < n; k++) {
+        unsigned int mag = p_mag[k];
+
+        if ((mag > thr) && ((unsigned long long)mag*num_train*256 > sum*scale_q8)) {
+            add_record(p_det_inst, frame_id, k, mag);
+            detections++;
+        }
+
+        // slide to k + 1: the leading window gains k+G+T+1 and loses k+G+1, the
+        // lagging one gains k-G and loses k-G-T
+        sum += p_mag[(k + G + T + 1) % n];
+        sum -= p_mag[(k + G + 1) % n];
+        sum += p_mag[(k - G + n) % n];
+        sum -= p_mag[(k - G - T + 2*n) % n];
+    }
+
+    return detections;
+}
+
+static void forward(detector_t* p_det_inst, const complex_sample_t* p_spectrum, unsigned int frame_id) {
+    if (p_det_inst->spectrum_fn != NULL) {
+        p_det_inst->spectrum_fn(p_spectrum, p_det_inst->num_pts, frame_id, p_det_inst->p_spectrum_ctx);
+    }
+    p_det_inst->stats.frames_forwarded++;
+}
+
+// the dma buffer is reused as soon as we return, so history is a copy
+static void push_history(detector_t* p_det_inst, const complex_sample_t* p_spectrum, unsigned int frame_id) {
+    int pre = p_det_inst->config.pre_trigger;
+
+    memcpy(&p_det_inst->p_hist[p_det_inst->hist_head * p_det_inst->num_pts], p_spectrum, sizeof(complex_sample_t)*p_det_inst->num_pts);
+    p_det_inst->hist_ids[p_det_inst->hist_head] = frame_id;
+
+    p_det_inst->hist_head = (p_det_inst->hist_head + 1) % pre;
+    if (p_det_inst->hist_count < pre) {
+        p_det_inst->hist_count++;
+    }
+}
+
+static void flush_history(detector_t* p_det_inst) {
+    int pre  = p_det_inst->config.pre_trigger;
+    int slot = (p_det_inst->hist_head - p_det_inst->hist_count + pre) % pre;
+
+    for (int i = 0; i < p_det_inst->hist_count; i++) {
+        forward(p_det_inst, &p_det_inst->p_hist[slot * p_det_inst->num_pts], p_det_inst->hist_ids[slot]);
+        slot = (slot + 1) % pre;
+    }
+
+    p_det_inst->hist_count = 0;
+}
+
+static void output_hook(const complex_sample_t* p_dout, int num_pts, fft_fwd_inv_t fwd_inv, unsigned int frame_id, void* p_ctx) {
+    detector_t* p_det_inst = (detector_t*)p_ctx;
+
+    // the engine may also run transforms for someone else: other sizes, and
+    // inverse transforms (correlator, channelizer) whose output isn't a spectrum
+    if ((fwd_inv == FFT_FORWARD) && (num_pts == p_det_inst->num_pts)) {
+        detector_process(p_det_inst, p_dout, frame_id);
+    }
+}
+
+// Public functions
+detector_t* detector_create(int num_pts, const detector_config_t* p_config) {
+
+    if ((num_pts < 1) || (num_pts > FFT_MAX_NUM_PTS) || (p_config == NULL) ||
+        (p_config->pre_trigger < 0) || (p_config->pre_trigger > DETECTOR_MAX_PRE_TRIGGER) ||
+        (p_config->post_trigger < 0)) {
+        xil_printf("ERROR! Illegal detector parameters.\n\r");
+        return NULL;
+    }
+
+    if ((p_config->mode != DETECTOR_MODE_THRESHOLD) && (p_config->mode != DETECTOR_MODE_CFAR)) {
+        xil_printf("ERROR! Unknown detector mode %d.\n\r", p_config->mode);
+        return NULL;
+    }
+
+    if ((p_config->mode == DETECTOR_MODE_CFAR) &&
+        ((p_config->guard_cells < 0) || (p_config->train_cells < 1) || (p_config->train_cells > DETECTOR_MAX_TRAIN_CELLS) ||
+         (2*(p_config->guard_cells + p_config->train_cells) + 1 > num_pts) ||
+         !(p_config->cfar_scale > 0.0f) || (p_config->cfar_scale > DETECTOR_MAX_CFAR_SCALE))) {
+        xil_printf("ERROR! Illegal CFAR window for a %d-point spectrum.\n\r", num_pts);
+        return NULL;
+    }
+
+    detector_t* p_obj = (detector_t*) calloc(1, sizeof(detector_t));
+    if (p_obj == NULL) {
+        xil_printf("ERROR! Failed to allocate memory for detector object.\n\r");
+        return NULL;
+    }
+
+    p_obj->num_pts = num_pts;
+    p_obj->config  = *p_config;
+
+    if (p_config->mode == DETECTOR_MODE_CFAR) {
+        p_obj->cfar_scale_q8 = (unsigned int)(p_config->cfar_scale*256.0f + 0.5f);
+        p_obj->p_mag         = (unsigned int*) malloc(sizeof(unsigned int)*num_pts);
+        if (p_obj->p_mag == NULL) {
+            xil_printf("ERROR! Failed to allocate memory for detector buffers.\n\r");
+            detector_destroy(p_obj);
+            return NULL;
+        }
+    }
+
+    if (p_config->pre_trigger > 0) {
+        p_obj->p_hist = (complex_sample_t*) malloc(sizeof(complex_sample_t)*num_pts*p_config->pre_trigger);
+        if (p_obj->p_hist == NULL) {
+            xil_printf("ERROR! Failed to allocate memory for detector buffers.\n\r");
+            detector_destroy(p_obj);
+            return NULL;
+        }
+    }
+
+    return p_obj;
+
+}
+
+void detector_destroy(detector_t* p_det_inst) {
+    free(p_det_inst->p_mag);
+    free(p_det_inst->p_hist);
+    free(p_det_inst);
+}
+
+void detector_set_record_fn(detector_t* p_det_inst, detector_record_fn record_fn, void* p_ctx) {
+    p_det_inst->record_fn    = record_fn;
+    p_det_inst->p_record_ctx = p_ctx;
+}
+
+void detector_set_spectrum_fn(detector_t* p_det_inst, detector_spectrum_fn spectrum_fn, void* p_ctx) {
+    p_det_inst->spectrum_fn    = spectrum_fn;
+    p_det_inst->p_spectrum_ctx = p_ctx;
+}
+
+void detector_attach(detector_t* p_det_inst, fft_t* p_fft_inst) {
+    fft_set_output_hook(p_fft_inst, output_hook, p_det_inst);
+}
+
+int detector_process(detector_t* p_det_inst, const complex_sample_t* p_spectrum, unsigned int frame_id) {
+
+    int detections;
+
+    p_det_inst->num_records = 0;
+    p_det_inst->stats.frames++;
+
+    if (p_det_inst->config.mode == DETECTOR_MODE_CFAR) {
+        detections = scan_cfar(p_det_inst, p_spectrum, frame_id);
+    } else {
+        detections = scan_threshold(p_det_inst, p_spectrum, frame_id);
+    }
+
+    if ((p_det_inst->num_records > 0) && (p_det_inst->record_fn != NULL)) {
+        p_det_inst->record_fn(p_det_inst->records, p_det_inst->num_records, p_det_inst->p_record_ctx);
+    }
+
+    if (detections > 0) {
+        p_det_inst->stats.frames_triggered++;
+        p_det_inst->stats.detections += detections;
+
+        // a trigger inside the post window just extends it
+        flush_history(p_det_inst);
+        forward(p_det_inst, p_spectrum, frame_id);
+        p_det_inst->post_remaining = p_det_inst->config.post_trigger;
+    } else if (p_det_inst->post_remaining > 0) {
+        forward(p_det_inst, p_spectrum, frame_id);
+        p_det_inst->post_remaining--;
+    } else if ((p_det_inst->config.pre_trigger > 0) && (p_det_inst->spectrum_fn != NULL)) {
+        push_history(p_det_inst, p_spectrum, frame_id);
+    }
+
+    return detections;
+}
+
+void detector_get_stats(detector_t* p_det_inst, detector_stats_t* p_stats) {
+    *p_stats = p_det_inst->stats;
+}
+
+void detector_reset_stats(detector_t* p_det_inst) {
+    memset(&p_det_inst->stats, 0, sizeof(detector_stats_t));
+}
+
+void detector_print_stats(detector_t* p_det_inst) {
+
+    detector_stats_t* p_stats = &p_det_inst->stats;
+
+    xil_printf("frames          = %d\n\r", p_stats->frames);
+    xil_printf("triggered       = %d\n\r", p_stats->frames_triggered);
+    xil_printf("forwarded       = %d\n\r", p_stats->frames_forwarded);
+    xil_printf("detections      = %d\n\r", p_stats->detections);
+    xil_printf("records dropped = %d\n\r", p_stats->records_dropped);
+
+}
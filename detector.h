@@ -0,0 +1,89 @@
+#ifndef DETECTOR_H
+#define DETECTOR_H
+
+#include "complex_sample.h"
+#include "fft.h"
+
+#define DETECTOR_SUCCESS          0
+#define DETECTOR_ILLEGAL_PARAMS  -1
+
+// records kept per frame, further detections in the same frame are only counted
+#define DETECTOR_MAX_RECORDS      64
+
+// frames of pre-trigger history
+#define DETECTOR_MAX_PRE_TRIGGER  16
+
+// training cells each side of the bin under test
+#define DETECTOR_MAX_TRAIN_CELLS  64
+
+// cfar_scale is applied in 8-bit fixed point
+#define DETECTOR_MAX_CFAR_SCALE   255.0f
+
+typedef enum
+{
+    // fire on |X|^2 above a fixed threshold
+    DETECTOR_MODE_THRESHOLD = 0,
+    // cell averaging cfar: fire on |X|^2 above cfar_scale times the mean of the
+    // training cells either side of the bin, skipping the guard cells
+    DETECTOR_MODE_CFAR      = 1
+} detector_mode_t;
+
+typedef struct detector_config
+{
+    detector_mode_t mode;
+    unsigned int    threshold;      // |X|^2 in core output units, also a floor for cfar
+    int             guard_cells;    // each side
+    int             train_cells;    // each side
+    float           cfar_scale;
+    int             pre_trigger;    // frames forwarded from before a trigger
+    int             post_trigger;   // frames forwarded after the last trigger
+} detector_config_t;
+
+typedef struct detection_record
+{
+    unsigned int   frame_id;
+    unsigned short bin;
+    unsigned short reserved;
+    unsigned int   magnitude;       // |X|^2
+} detection_record_t;
+
+typedef struct detector_stats
+{
+    unsigned int frames;
+    unsigned int frames_triggered;
+    unsigned int frames_forwarded;
+    unsigned int detections;
+    unsigned int records_dropped;   // detections past DETECTOR_MAX_RECORDS
+} detector_stats_t;
+
+typedef struct detector detector_t;
+
+// records of one frame, only called when there are any
+typedef void (*detector_record_fn)(const detection_record_t* p_records, int num_records, void* p_ctx);
+
+// full spectra around a trigger, oldest first
+typedef void (*detector_spectrum_fn)(const complex_sample_t* p_spectrum, int num_pts, unsigned int frame_id, void* p_ctx);
+
+detector_t* detector_create(int num_pts, const detector_config_t* p_config);
+
+void detector_destroy(detector_t* p_det_inst);
+
+void detector_set_record_fn(detector_t* p_det_inst, detector_record_fn record_fn, void* p_ctx);
+
+void detector_set_spectrum_fn(detector_t* p_det_inst, detector_spectrum_fn spectrum_fn, void* p_ctx);
+
+// run the detector on every forward transform of its size that p_fft_inst
+// completes, through its output hook
+void detector_attach(detector_t* p_det_inst, fft_t* p_fft_inst);
+
+// scan one spectrum, emit its records and forward it if it's inside a trigger
+// window. Returns the number of detections
+int detector_process(detector_t* p_det_inst, const complex_sample_t* p_spectrum, unsigned int frame_id);
+
+void detector_get_stats(detector_t* p_det_inst, detector_stats_t* p_stats);
+
+void detector_reset_stats(detector_t* p_det_inst);
+
+void detector_print_stats(detector_t* p_det_inst);
+
+#endif // DETECTOR_H
@@ -1,138 +1,375 @@
-
 #include <stdlib.h>
+#include <malloc.h>
 #include "xaxidma.h"
 #include "xscugic.h"
+#include "xtime_l.h"
 #include "dma_accel.h"
+#include "fft_registry.h"
+#include "trace.h"
 #define RESET_TIMEOUT_COUNTER 10000
 
-static int g_s2mm_done = 0;
-static int g_mm2s_done = 0;
-static int g_dma_err   = 0;
-
 typedef struct dma_accel_periphs {
-    XAxiDma dma_inst;
-    XScuGic intc_inst;
+    XAxiDma  dma_inst;
+    XScuGic  intc_inst;    // own controller, dma_accel_create only
+    XScuGic* p_intc_inst;  // the one the isrs are connected to
+    int      s2mm_intr_id;
+    int      mm2s_intr_id;
 } dma_accel_periphs_t;
 
+// the transfer currently owned by the engine
+typedef struct dma_accel_xfer {
+    unsigned int                id;
+    void*                       p_input_buf;
+    void*                       p_output_buf;
+    int                         num_bytes;
+    int                         in_place;
+    dma_accel_completion_mode_t mode;
+    volatile int                mm2s_reported; // producer side: completion pushed to the ring
+    volatile int                s2mm_reported;
+    volatile int                writeback_started; // in-place: S2MM may have overwritten the input
+    int                         pending;       // consumer side: channel completions not yet drained
+    int                         failed;        // consumer side: a channel reported an error
+    int                         retries;       // times this frame has been resubmitted
+    int                         trace_open;    // channels with an xfer trace span begun and not yet ended, one bit each
+} dma_accel_xfer_t;
+
 typedef struct dma_accel {
-    dma_accel_periphs_t periphs;
-    void*               p_input_buf;
-    void*               p_output_buf;
-    int                 buf_length;
-    int                 sample_size_bytes;
+    dma_accel_periphs_t           periphs;
+    int                           ready;           // out of reset with interrupts enabled
+    void*                         p_input_buf;
+    void*                         p_output_buf;
+    int                           buf_length;
+    int                           sample_size_bytes;
+    dma_accel_completion_mode_t   completion_mode;
+    dma_accel_completion_mode_t   active_mode;     // mode the dma interrupt enables are currently set up for
+    int                           queue_depth;
+    unsigned int                  next_id;
+    dma_accel_xfer_t              xfer;
+    completion_ring_t             completions;
+    volatile int                  fault_pending;   // set by the producer, cleared by dma_accel_recover
+    unsigned long long            fault_time;
+    int                           max_retries;
+    dma_accel_fault_stats_t       fault_stats;
+#ifdef DMA_ACCEL_FAULT_INJECTION
+    volatile int                  inject_faults;
+#endif
 } dma_accel_t;
 
-// interrupt service routine for stream to memory-mapped
-static void s2mm_isr(void* CallbackRef) {
-    XAxiDma* p_dma_inst = (XAxiDma*)CallbackRef;
+static void trace_xfer_begin(dma_accel_xfer_t* p_xfer, int channel) {
+    p_xfer->trace_open |= 1 << channel;
+    if (channel == DMA_ACCEL_CHANNEL_MM2S) {
+        TRACE_BEGIN(TRACE_EV_MM2S_XFER, TRACE_TRACK_MM2S, p_xfer->id);
+    } else {
+        TRACE_BEGIN(TRACE_EV_S2MM_XFER, TRACE_TRACK_S2MM, p_xfer->id);
+    }
+}
+
+// ends the span once, however many times the channel is reported or faulted
+static void trace_xfer_end(dma_accel_xfer_t* p_xfer, int channel) {
+    if (!(p_xfer->trace_open & (1 << channel))) {
+        return;
+    }
+    p_xfer->trace_open &= ~(1 << channel);
+    if (channel == DMA_ACCEL_CHANNEL_MM2S) {
+        TRACE_END(TRACE_EV_MM2S_XFER, TRACE_TRACK_MM2S, p_xfer->id);
+    } else {
+        TRACE_END(TRACE_EV_S2MM_XFER, TRACE_TRACK_S2MM, p_xfer->id);
+    }
+}
+
+// producer side: a channel reported an error. Only masks the dma interrupts
+// so the engine stays quiet; the reset itself is left to dma_accel_recover,
+// which runs outside interrupt context
+static void enter_fault(dma_accel_t* p_dma_accel_inst) {
+
+    XAxiDma* p_dma_inst = &p_dma_accel_inst->periphs.dma_inst;
+    XTime    now;
 
-    // turn off interrupts so we don't get re-interrupted
     XAxiDma_IntrDisable(p_dma_inst, XAXIDMA_IRQ_ALL_MASK, XAXIDMA_DMA_TO_DEVICE);
     XAxiDma_IntrDisable(p_dma_inst, XAXIDMA_IRQ_ALL_MASK, XAXIDMA_DEVICE_TO_DMA);
 
-    // read irq status
-    int irq_status = XAxiDma_IntrGetIrq(p_dma_inst, XAXIDMA_DEVICE_TO_DMA);
+    // adaptive is never armed directly, so this forces the enables to be reprogrammed
+    p_dma_accel_inst->active_mode = DMA_ACCEL_COMPLETION_ADAPTIVE;
 
-    // acknowledge any pending interrupts
-    XAxiDma_IntrAckIrq(p_dma_inst, irq_status, XAXIDMA_DEVICE_TO_DMA);
+    // a faulted channel may never report, close its span so the trace stays balanced
+    trace_xfer_end(&p_dma_accel_inst->xfer, DMA_ACCEL_CHANNEL_MM2S);
+    trace_xfer_end(&p_dma_accel_inst->xfer, DMA_ACCEL_CHANNEL_S2MM);
 
-    // if there are no asserted interrupts, there's nothing to do
-    if (!(irq_status & XAXIDMA_IRQ_ALL_MASK)) {
-        // re-enable interrupts
-        XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DMA_TO_DEVICE);
-        XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DEVICE_TO_DMA);
-        return;
+    if (!p_dma_accel_inst->fault_pending) {
+        XTime_GetTime(&now);
+        p_dma_accel_inst->fault_time    = now;
+        p_dma_accel_inst->fault_pending = 1;
     }
 
-    // error interrupt
-    if ((irq_status & XAXIDMA_IRQ_ERROR_MASK)) {
+}
+
+// producer side: report a finished channel of the current transfer
+static void report_completion(dma_accel_t* p_dma_accel_inst, int channel, int status) {
 
-        // error flag
-        g_dma_err = 1;
+    dma_accel_xfer_t*  p_xfer = &p_dma_accel_inst->xfer;
+    completion_entry_t entry;
+    XTime              now;
 
-        // try to reset dma
-        XAxiDma_Reset(p_dma_inst);
-        for (int i = 0; i < RESET_TIMEOUT_COUNTER; i++) {
-            if (XAxiDma_ResetIsDone(p_dma_inst)) {
-                break;
-            }
+#ifdef DMA_ACCEL_FAULT_INJECTION
+    // turn a good completion into an error, as if the channel had faulted
+    if ((status == DMA_ACCEL_SUCCESS) && (p_dma_accel_inst->inject_faults > 0)) {
+        p_dma_accel_inst->inject_faults--;
+        enter_fault(p_dma_accel_inst);
+        status = DMA_ACCEL_TRANSFER_FAIL;
+    }
+#endif
+
+    XTime_GetTime(&now);
+
+    entry.id        = p_xfer->id;
+    entry.channel   = channel;
+    entry.status    = status;
+    entry.num_bytes = p_xfer->num_bytes;
+    entry.timestamp = now;
+
+    if (channel == DMA_ACCEL_CHANNEL_MM2S) {
+        p_xfer->mm2s_reported = 1;
+    } else {
+        p_xfer->s2mm_reported = 1;
+    }
+    trace_xfer_end(p_xfer, channel);
+
+    completion_ring_push(&p_dma_accel_inst->completions, &entry);
+
+    // in-place: the frame has been read out, so the write-back can start now
+    if ((channel == DMA_ACCEL_CHANNEL_MM2S) && (status == DMA_ACCEL_SUCCESS) && p_xfer->in_place) {
+        p_xfer->writeback_started = 1;
+        TRACE_BEGIN(TRACE_EV_S2MM_SUBMIT, TRACE_TRACK_ISR, p_xfer->id);
+        int xfer_status = XAxiDma_SimpleTransfer(&p_dma_accel_inst->periphs.dma_inst, (int)p_xfer->p_output_buf, p_xfer->num_bytes, XAXIDMA_DEVICE_TO_DMA);
+        TRACE_END(TRACE_EV_S2MM_SUBMIT, TRACE_TRACK_ISR, p_xfer->id);
+        trace_xfer_begin(p_xfer, DMA_ACCEL_CHANNEL_S2MM);
+        if (xfer_status != XST_SUCCESS) {
+            enter_fault(p_dma_accel_inst);
+            report_completion(p_dma_accel_inst, DMA_ACCEL_CHANNEL_S2MM, DMA_ACCEL_TRANSFER_FAIL);
         }
+    }
 
-        // re-enable interrupts
-        XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DMA_TO_DEVICE);
-        XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DEVICE_TO_DMA);
+}
 
-        return;
+// common interrupt handling for one channel. Returns the asserted irq bits.
+static int service_channel_irq(dma_accel_t* p_dma_accel_inst, int direction) {
+
+    XAxiDma* p_dma_inst = &p_dma_accel_inst->periphs.dma_inst;
+    int      channel    = (direction == XAXIDMA_DMA_TO_DEVICE) ? DMA_ACCEL_CHANNEL_MM2S : DMA_ACCEL_CHANNEL_S2MM;
+
+    // read and acknowledge pending interrupts on this channel only. The GIC
+    // won't re-enter this handler until we return, so there's no need to mask
+    int irq_status = XAxiDma_IntrGetIrq(p_dma_inst, direction);
+    XAxiDma_IntrAckIrq(p_dma_inst, irq_status, direction);
+
+    // error interrupt
+    if (irq_status & XAXIDMA_IRQ_ERROR_MASK) {
+        enter_fault(p_dma_accel_inst);
+        report_completion(p_dma_accel_inst, channel, DMA_ACCEL_TRANSFER_FAIL);
+        return XAXIDMA_IRQ_ERROR_MASK;
     }
 
     // completed interrupt
     if (irq_status & XAXIDMA_IRQ_IOC_MASK) {
-        // flag that s2mm is completed
-        g_s2mm_done = 1;
+        report_completion(p_dma_accel_inst, channel, DMA_ACCEL_SUCCESS);
     }
-    
-    // re-enable interrupts
-    XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DMA_TO_DEVICE);
-    XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DEVICE_TO_DMA);
+
+    return irq_status & XAXIDMA_IRQ_ALL_MASK;
+
+}
+
+// interrupt service routine for stream to memory-mapped
+static void s2mm_isr(void* CallbackRef) {
+    dma_accel_t*      p_dma_accel_inst = (dma_accel_t*)CallbackRef;
+    dma_accel_xfer_t* p_xfer           = &p_dma_accel_inst->xfer;
+
+    TRACE_BEGIN(TRACE_EV_S2MM_ISR, TRACE_TRACK_ISR, p_xfer->id);
+
+    int irq_status = service_channel_irq(p_dma_accel_inst, XAXIDMA_DEVICE_TO_DMA);
+
+    // coalesced: MM2S raised no completion interrupt of its own. The core only
+    // emits output once it has consumed the frame, so MM2S is done by now. In
+    // interrupt mode mm2s_isr reports it, even if the GIC runs this one first
+    if ((p_dma_accel_inst->active_mode == DMA_ACCEL_COMPLETION_COALESCED) &&
+        (irq_status & XAXIDMA_IRQ_IOC_MASK) && !p_xfer->mm2s_reported) {
+        report_completion(p_dma_accel_inst, DMA_ACCEL_CHANNEL_MM2S, DMA_ACCEL_SUCCESS);
+    }
+
+    TRACE_END(TRACE_EV_S2MM_ISR, TRACE_TRACK_ISR, p_xfer->id);
 
 }
 
 // interrupt service routine for memory-mapped to stream
 static void mm2s_isr(void* CallbackRef) {
-    XAxiDma* p_dma_inst = (XAxiDma*)CallbackRef;
+    dma_accel_t* p_dma_accel_inst = (dma_accel_t*)CallbackRef;
+
+    TRACE_BEGIN(TRACE_EV_MM2S_ISR, TRACE_TRACK_ISR, p_dma_accel_inst->xfer.id);
+    service_channel_irq(p_dma_accel_inst, XAXIDMA_DMA_TO_DEVICE);
+    TRACE_END(TRACE_EV_MM2S_ISR, TRACE_TRACK_ISR, p_dma_accel_inst->xfer.id);
+}
+
+// program the dma interrupt enables for a (resolved, non-adaptive) completion mode
+static void arm_completion_mode(dma_accel_t* p_dma_accel_inst, dma_accel_completion_mode_t mode) {
+
+    XAxiDma* p_dma_inst = &p_dma_accel_inst->periphs.dma_inst;
+
+    if (p_dma_accel_inst->active_mode == mode) {
+        return;
+    }
 
-  // turn off interrupts so we don't get re-interrupted
     XAxiDma_IntrDisable(p_dma_inst, XAXIDMA_IRQ_ALL_MASK, XAXIDMA_DMA_TO_DEVICE);
     XAxiDma_IntrDisable(p_dma_inst, XAXIDMA_IRQ_ALL_MASK, XAXIDMA_DEVICE_TO_DMA);
 
-    // read irq status
-    int irq_status = XAxiDma_IntrGetIrq(p_dma_inst, XAXIDMA_DMA_TO_DEVICE);
-
-    // acknowledge any pending interrupts
-    XAxiDma_IntrAckIrq(p_dma_inst, irq_status, XAXIDMA_DMA_TO_DEVICE);
+    // polled transfers leave their status bits set. Clear them so they don't fire once unmasked
+    XAxiDma_IntrAckIrq(p_dma_inst, XAXIDMA_IRQ_ALL_MASK, XAXIDMA_DMA_TO_DEVICE);
+    XAxiDma_IntrAckIrq(p_dma_inst, XAXIDMA_IRQ_ALL_MASK, XAXIDMA_DEVICE_TO_DMA);
 
-    // if there are no asserted interrupts, there's nothing to do
-    if (!(irq_status & XAXIDMA_IRQ_ALL_MASK)) {
-        // re-enable interrupts
+    if (mode == DMA_ACCEL_COMPLETION_INTERRUPT) {
+        // completion and error interrupts on both channels
         XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DMA_TO_DEVICE);
         XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DEVICE_TO_DMA);
+    } else if (mode == DMA_ACCEL_COMPLETION_COALESCED) {
+        // one completion interrupt per frame from S2MM; MM2S only reports errors
+        XAxiDma_IntrEnable(p_dma_inst, XAXIDMA_IRQ_ERROR_MASK, XAXIDMA_DMA_TO_DEVICE);
+        XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DEVICE_TO_DMA);
+    }
+    // polled: everything stays masked
+
+    p_dma_accel_inst->active_mode = mode;
+
+}
+
+// polled mode: check the status register of one channel and report it once it has finished.
+// Runs in the consumer's context, which is then the only producer for the ring
+static void poll_channel(dma_accel_t* p_dma_accel_inst, int direction) {
+
+    XAxiDma* p_dma_inst = &p_dma_accel_inst->periphs.dma_inst;
+    int      channel    = (direction == XAXIDMA_DMA_TO_DEVICE) ? DMA_ACCEL_CHANNEL_MM2S : DMA_ACCEL_CHANNEL_S2MM;
+    int      offset     = (direction == XAXIDMA_DMA_TO_DEVICE) ? XAXIDMA_TX_OFFSET : XAXIDMA_RX_OFFSET;
+    u32      sr         = XAxiDma_ReadReg(p_dma_inst->RegBase, offset + XAXIDMA_SR_OFFSET);
+
+    if (sr & XAXIDMA_ERR_ALL_MASK) {
+        enter_fault(p_dma_accel_inst);
+        report_completion(p_dma_accel_inst, channel, DMA_ACCEL_TRANSFER_FAIL);
+    } else if (!XAxiDma_Busy(p_dma_inst, direction)) {
+        report_completion(p_dma_accel_inst, channel, DMA_ACCEL_SUCCESS);
+    }
+
+}
+
+static void poll_hardware(dma_accel_t* p_dma_accel_inst) {
+
+    dma_accel_xfer_t* p_xfer = &p_dma_accel_inst->xfer;
+
+    if ((p_xfer->pending == 0) || (p_xfer->mode != DMA_ACCEL_COMPLETION_POLLED)) {
         return;
     }
 
-    // error interrupt
-    if (irq_status & XAXIDMA_IRQ_ERROR_MASK) {
+    if (!p_xfer->mm2s_reported) {
+        poll_channel(p_dma_accel_inst, XAXIDMA_DMA_TO_DEVICE);
+    }
 
-        // error flag
-        g_dma_err = 1;
+    // an in-place S2MM is only started once MM2S has been reported
+    if (!p_xfer->s2mm_reported && (p_xfer->mm2s_reported || !p_xfer->in_place)) {
+        poll_channel(p_dma_accel_inst, XAXIDMA_DEVICE_TO_DMA);
+    }
 
-        // try to reset dma
-        XAxiDma_Reset(p_dma_inst);
-        for (int i = 0; i < RESET_TIMEOUT_COUNTER; i++) {
-            if (XAxiDma_ResetIsDone(p_dma_inst)) {
-                break;
-            }
-        }
+}
 
-        // re-enable interrupts
-        XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DMA_TO_DEVICE);
-        XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DEVICE_TO_DMA);
+// consumer side bookkeeping for one drained completion
+static void retire_completion(dma_accel_t* p_dma_accel_inst, const completion_entry_t* p_entry) {
+
+    dma_accel_xfer_t* p_xfer = &p_dma_accel_inst->xfer;
 
+    if ((p_xfer->pending == 0) || (p_entry->id != p_xfer->id)) {
         return;
     }
 
-    // completed interrupt
-    if (irq_status & XAXIDMA_IRQ_IOC_MASK) {
-        // flag that mm2s is done
-        g_mm2s_done = 1;
+    // an error ends the transfer, the other channel won't report
+    if (p_entry->status != DMA_ACCEL_SUCCESS) {
+        p_xfer->pending = 0;
+        p_xfer->failed  = 1;
+        p_dma_accel_inst->fault_stats.num_faults++;
+        return;
     }
 
-    // re-enable interrupts
-    XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DMA_TO_DEVICE);
-    XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DEVICE_TO_DMA);
+    // drop any lines the cpu speculatively pulled in while the dma was writing
+    if (p_entry->channel == DMA_ACCEL_CHANNEL_S2MM) {
+        TRACE_BEGIN(TRACE_EV_CACHE_INVALIDATE, TRACE_TRACK_CPU, p_xfer->id);
+        Xil_DCacheInvalidateRange((int)p_xfer->p_output_buf, p_xfer->num_bytes);
+        TRACE_END(TRACE_EV_CACHE_INVALIDATE, TRACE_TRACK_CPU, p_xfer->id);
+    }
+
+    p_xfer->pending--;
 
 }
 
-static int init_intc(XScuGic* p_intc_inst, int intc_device_id, XAxiDma* p_dma_inst, int s2mm_intr_id, int mm2s_intr_id) {
+// kick off (or re-kick after a fault) the transfer described by p_dma_accel_inst->xfer
+static int start_xfer(dma_accel_t* p_dma_accel_inst) {
+
+    dma_accel_xfer_t* p_xfer = &p_dma_accel_inst->xfer;
+
+    p_xfer->mm2s_reported = 0;
+    p_xfer->s2mm_reported = 0;
+    p_xfer->writeback_started = 0;
+    p_xfer->failed        = 0;
+    p_xfer->pending       = 2;
+
+    // resolve and arm the completion mode for this frame
+    dma_accel_completion_mode_t mode = p_dma_accel_inst->completion_mode;
+    if (mode == DMA_ACCEL_COMPLETION_ADAPTIVE) {
+        mode = dma_accel_select_completion_mode(p_xfer->num_bytes, p_dma_accel_inst->queue_depth);
+    }
+
+    // in-place needs to hear about MM2S completion to start the write-back
+    if ((mode == DMA_ACCEL_COMPLETION_COALESCED) && p_xfer->in_place) {
+        mode = DMA_ACCEL_COMPLETION_INTERRUPT;
+    }
+    p_xfer->mode = mode;
+    arm_completion_mode(p_dma_accel_inst, mode);
+
+    // flush cache. in-place transfers share one range, so a single flush covers both directions
+    TRACE_BEGIN(TRACE_EV_CACHE_FLUSH, TRACE_TRACK_CPU, p_xfer->id);
+    Xil_DCacheFlushRange((int)p_xfer->p_input_buf, p_xfer->num_bytes);
+    if (!p_xfer->in_place) {
+        Xil_DCacheFlushRange((int)p_xfer->p_output_buf, p_xfer->num_bytes);
+    }
+    TRACE_END(TRACE_EV_CACHE_FLUSH, TRACE_TRACK_CPU, p_xfer->id);
+
+    // arm S2MM first so the core never stalls on its output. In-place: the
+    // whole frame must be read out before S2MM may overwrite it, so S2MM is
+    // started when MM2S completes
+    int status;
+    if (!p_xfer->in_place) {
+        TRACE_BEGIN(TRACE_EV_S2MM_SUBMIT, TRACE_TRACK_CPU, p_xfer->id);
+        trace_xfer_begin(p_xfer, DMA_ACCEL_CHANNEL_S2MM);
+        status = XAxiDma_SimpleTransfer(&p_dma_accel_inst->periphs.dma_inst, (int)p_xfer->p_output_buf, p_xfer->num_bytes, XAXIDMA_DEVICE_TO_DMA);
+        TRACE_END(TRACE_EV_S2MM_SUBMIT, TRACE_TRACK_CPU, p_xfer->id);
+        if (status != XST_SUCCESS) {
+            xil_printf("ERROR! Failed to kick off S2MM transfer!\n\r");
+            trace_xfer_end(p_xfer, DMA_ACCEL_CHANNEL_S2MM);
+            p_xfer->pending = 0;
+            return DMA_ACCEL_TRANSFER_FAIL;
+        }
+    }
+
+    // MM2S transfer
+    TRACE_BEGIN(TRACE_EV_MM2S_SUBMIT, TRACE_TRACK_CPU, p_xfer->id);
+    trace_xfer_begin(p_xfer, DMA_ACCEL_CHANNEL_MM2S);
+    status = XAxiDma_SimpleTransfer(&p_dma_accel_inst->periphs.dma_inst, (int)p_xfer->p_input_buf, p_xfer->num_bytes, XAXIDMA_DMA_TO_DEVICE);
+    TRACE_END(TRACE_EV_MM2S_SUBMIT, TRACE_TRACK_CPU, p_xfer->id);
+    if (status != XST_SUCCESS) {
+        xil_printf("ERROR! Failed to kick off MM2S transfer!\n\r");
+        enter_fault(p_dma_accel_inst);
+        p_xfer->pending = 0;
+        return DMA_ACCEL_TRANSFER_FAIL;
+    }
+
+    return DMA_ACCEL_SUCCESS;
+
+}
+
+static int init_intc(XScuGic* p_intc_inst, int intc_device_id, dma_accel_t* p_dma_accel_inst, int s2mm_intr_id, int mm2s_intr_id) {
 
     // lookup hardware configuration 
     XScuGic_Config* cfg_ptr = XScuGic_LookupConfig(intc_device_id);
@@ -154,13 +391,13 @@ static int init_intc(XScuGic* p_intc_inst, int intc_device_id, XAxiDma* p_dma_in
     XScuGic_SetPriorityTriggerType(p_intc_inst, mm2s_intr_id, 0xA8, 0x3);
 
     // setup interrupt handlers
-    status = XScuGic_Connect(p_intc_inst, s2mm_intr_id, (Xil_InterruptHandler)s2mm_isr, p_dma_inst);
+    status = XScuGic_Connect(p_intc_inst, s2mm_intr_id, (Xil_InterruptHandler)s2mm_isr, p_dma_accel_inst);
     if (status != XST_SUCCESS)
     {
         xil_printf("ERROR! Failed to connect s2mm_isr to the interrupt controller.\r\n", status);
         return DMA_ACCEL_INTC_INIT_FAIL;
     }
-    status = XScuGic_Connect(p_intc_inst, mm2s_intr_id, (Xil_InterruptHandler)mm2s_isr, p_dma_inst);
+    status = XScuGic_Connect(p_intc_inst, mm2s_intr_id, (Xil_InterruptHandler)mm2s_isr, p_dma_accel_inst);
     if (status != XST_SUCCESS)
     {
         xil_printf("ERROR! Failed to connect mm2s_isr to the interrupt controller.\r\n", status);
@@ -207,20 +444,70 @@ static int init_dma(XAxiDma* p_dma_inst, int dma_device_id) {
         return DMA_ACCEL_DMA_INIT_FAIL;
     }
 
-    // reset
+    // start the reset. dma_accel_poll_ready sees it through and enables interrupts
     XAxiDma_Reset(p_dma_inst);
-    while (!XAxiDma_ResetIsDone(p_dma_inst)) {
-        // empty
-    }
 
-    // enable dma interrupts
-    XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DMA_TO_DEVICE);
-    XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DEVICE_TO_DMA);
+    return DMA_ACCEL_SUCCESS;
+
+}
+
+// a shared controller is already set up, only hook this engine's isrs into it.
+// The lines are enabled once the engine is out of reset
+static int connect_shared_intc(XScuGic* p_intc_inst, dma_accel_t* p_dma_accel_inst, int s2mm_intr_id, int mm2s_intr_id) {
+
+    XScuGic_SetPriorityTriggerType(p_intc_inst, s2mm_intr_id, 0xA0, 0x3);
+    XScuGic_SetPriorityTriggerType(p_intc_inst, mm2s_intr_id, 0xA8, 0x3);
+
+    int status = XScuGic_Connect(p_intc_inst, s2mm_intr_id, (Xil_InterruptHandler)s2mm_isr, p_dma_accel_inst);
+    if (status != XST_SUCCESS)
+    {
+        xil_printf("ERROR! Failed to connect s2mm_isr to the interrupt controller.\r\n");
+        return DMA_ACCEL_INTC_INIT_FAIL;
+    }
+    status = XScuGic_Connect(p_intc_inst, mm2s_intr_id, (Xil_InterruptHandler)mm2s_isr, p_dma_accel_inst);
+    if (status != XST_SUCCESS)
+    {
+        xil_printf("ERROR! Failed to connect mm2s_isr to the interrupt controller.\r\n");
+        return DMA_ACCEL_INTC_INIT_FAIL;
+    }
 
     return DMA_ACCEL_SUCCESS;
 
 }
 
+static void init_state(dma_accel_t* p_obj, int sample_size_bytes) {
+
+    // init buffer pointers
+    dma_accel_set_input_buf(p_obj, NULL);
+    dma_accel_set_output_buf(p_obj, NULL);
+
+    // init buffer length
+    dma_accel_set_buf_length(p_obj, 1024);
+
+    // init sample size
+    dma_accel_set_sample_size_bytes(p_obj, sample_size_bytes);
+
+    // init completion tracking
+    p_obj->next_id         = 0;
+    p_obj->xfer.pending    = 0;
+    p_obj->xfer.trace_open = 0;
+    completion_ring_init(&p_obj->completions);
+
+    // init fault recovery
+    p_obj->fault_pending = 0;
+    dma_accel_set_max_retries(p_obj, DMA_ACCEL_DEFAULT_MAX_RETRIES);
+    dma_accel_reset_fault_stats(p_obj);
+#ifdef DMA_ACCEL_FAULT_INJECTION
+    p_obj->inject_faults = 0;
+#endif
+
+    // init completion mode. dma_accel_poll_ready arms interrupt-per-frame
+    p_obj->active_mode = DMA_ACCEL_COMPLETION_INTERRUPT;
+    dma_accel_set_completion_mode(p_obj, DMA_ACCEL_COMPLETION_ADAPTIVE);
+    dma_accel_set_queue_depth(p_obj, 1);
+
+}
+
 // Public functions
 dma_accel_t* dma_accel_create(int dma_device_id, int intc_device_id, int s2mm_intr_id, int mm2s_intr_id, int sample_size_bytes) {
 
@@ -232,39 +519,148 @@ dma_accel_t* dma_accel_create(int dma_device_id, int intc_device_id, int s2mm_in
     }
 
     // register and initialize peripherals
+    p_obj->ready               = 0;
+    p_obj->periphs.p_intc_inst = NULL;
+    init_state(p_obj, sample_size_bytes);
+
     int status = init_dma(&p_obj->periphs.dma_inst, dma_device_id);
+    if (status == DMA_ACCEL_SUCCESS) {
+        status = dma_accel_wait_ready(p_obj, DMA_ACCEL_RESET_TIMEOUT_US);
+    }
     if (status != DMA_ACCEL_SUCCESS) {
         xil_printf("ERROR! Failed to initialize AXI DMA.\n\r");
         dma_accel_free(p_obj);
         return NULL;
     }
 
-    status = init_intc(&p_obj->periphs.intc_inst, intc_device_id, &p_obj->periphs.dma_inst, s2mm_intr_id, mm2s_intr_id);
+    status = init_intc(&p_obj->periphs.intc_inst, intc_device_id, p_obj, s2mm_intr_id, mm2s_intr_id);
     
     if (status != DMA_ACCEL_SUCCESS) {
         xil_printf("ERROR! Failed to initialize Interrupt controller.\n\r");
         dma_accel_free(p_obj);
         return NULL;
     }
+    p_obj->periphs.p_intc_inst  = &p_obj->periphs.intc_inst;
+    p_obj->periphs.s2mm_intr_id = s2mm_intr_id;
+    p_obj->periphs.mm2s_intr_id = mm2s_intr_id;
 
-    // init buffer pointers
-    dma_accel_set_input_buf(p_obj, NULL);
-    dma_accel_set_output_buf(p_obj, NULL);
+    return p_obj;
 
-    // init buffer length
-    dma_accel_set_buf_length(p_obj, 1024);
+}
 
-    // init sample size
-    dma_accel_set_sample_size_bytes(p_obj, sample_size_bytes);
+dma_accel_t* dma_accel_create_ex(int dma_device_id, XScuGic* p_intc_inst, int s2mm_intr_id, int mm2s_intr_id, int sample_size_bytes) {
+
+    dma_accel_t* p_obj = (dma_accel_t*) malloc(sizeof(dma_accel_t));
+    if (p_obj == NULL) {
+        xil_printf("ERROR! Failed to allocate memory for DMA Accelerator object.\n\r");
+        return NULL;
+    }
+
+    p_obj->ready               = 0;
+    p_obj->periphs.p_intc_inst = NULL;
+    init_state(p_obj, sample_size_bytes);
+
+    int status = init_dma(&p_obj->periphs.dma_inst, dma_device_id);
+    if (status != DMA_ACCEL_SUCCESS) {
+        xil_printf("ERROR! Failed to initialize AXI DMA.\n\r");
+        dma_accel_free(p_obj);
+        return NULL;
+    }
+
+    // from here on dma_accel_free takes the lines back off the controller
+    p_obj->periphs.p_intc_inst  = p_intc_inst;
+    p_obj->periphs.s2mm_intr_id = s2mm_intr_id;
+    p_obj->periphs.mm2s_intr_id = mm2s_intr_id;
+
+    status = connect_shared_intc(p_intc_inst, p_obj, s2mm_intr_id, mm2s_intr_id);
+    if (status != DMA_ACCEL_SUCCESS) {
+        xil_printf("ERROR! Failed to connect AXI DMA to the interrupt controller.\n\r");
+        dma_accel_free(p_obj);
+        return NULL;
+    }
 
     return p_obj;
 
 }
 
 void dma_accel_free(dma_accel_t* p_dma_accel_inst) {
+
+    dma_accel_periphs_t* p_periphs = &p_dma_accel_inst->periphs;
+
+    // the isrs and, with its own controller, the exception table point into this
+    // object. Quiet the dma and unhook them all before it's freed
+    if (p_periphs->p_intc_inst != NULL) {
+        XAxiDma_IntrDisable(&p_periphs->dma_inst, XAXIDMA_IRQ_ALL_MASK, XAXIDMA_DMA_TO_DEVICE);
+        XAxiDma_IntrDisable(&p_periphs->dma_inst, XAXIDMA_IRQ_ALL_MASK, XAXIDMA_DEVICE_TO_DMA);
+
+        XScuGic_Disable(p_periphs->p_intc_inst, p_periphs->s2mm_intr_id);
+        XScuGic_Disable(p_periphs->p_intc_inst, p_periphs->mm2s_intr_id);
+        XScuGic_Disconnect(p_periphs->p_intc_inst, p_periphs->s2mm_intr_id);
+        XScuGic_Disconnect(p_periphs->p_intc_inst, p_periphs->mm2s_intr_id);
+
+        if (p_periphs->p_intc_inst == &p_periphs->intc_inst) {
+            Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT, (Xil_ExceptionHandler)Xil_ExceptionNullHandler, NULL);
+        }
+    }
+
     free(p_dma_accel_inst);
 }
 
+int dma_accel_poll_ready(dma_accel_t* p_dma_accel_inst) {
+
+    XAxiDma* p_dma_inst = &p_dma_accel_inst->periphs.dma_inst;
+
+    if (p_dma_accel_inst->ready) {
+        return DMA_ACCEL_SUCCESS;
+    }
+
+    if (!XAxiDma_ResetIsDone(p_dma_inst)) {
+        return DMA_ACCEL_BUSY;
+    }
+
+    // enable dma interrupts
+    XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DMA_TO_DEVICE);
+    XAxiDma_IntrEnable(p_dma_inst, (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK), XAXIDMA_DEVICE_TO_DMA);
+
+    // dma_accel_create enables its own controller's lines later, in init_intc
+    if (p_dma_accel_inst->periphs.p_intc_inst != NULL) {
+        XScuGic_Enable(p_dma_accel_inst->periphs.p_intc_inst, p_dma_accel_inst->periphs.s2mm_intr_id);
+        XScuGic_Enable(p_dma_accel_inst->periphs.p_intc_inst, p_dma_accel_inst->periphs.mm2s_intr_id);
+    }
+
+    p_dma_accel_inst->ready = 1;
+
+    return DMA_ACCEL_SUCCESS;
+
+}
+
+int dma_accel_wait_ready(dma_accel_t* p_dma_accel_inst, int timeout_us) {
+
+    XTime start, now;
+    int   status;
+
+    XTime_GetTime(&start);
+    while ((status = dma_accel_poll_ready(p_dma_accel_inst)) == DMA_ACCEL_BUSY) {
+        XTime_GetTime(&now);
+        if ((now - start) >= ((XTime)timeout_us*COUNTS_PER_SECOND)/1000000) {
+            xil_printf("ERROR! AXI DMA did not come out of reset within %d us.\n\r", timeout_us);
+            return DMA_ACCEL_DMA_INIT_FAIL;
+        }
+    }
+
+    return status;
+
+}
+
+void* dma_accel_alloc_buf(int num_bytes) {
+    int padded = (num_bytes + DMA_ACCEL_BUF_ALIGN - 1) & ~(DMA_ACCEL_BUF_ALIGN - 1);
+    return memalign(DMA_ACCEL_BUF_ALIGN, padded);
+}
+
+void dma_accel_free_buf(void* p_buf) {
+    free(p_buf);
+}
+
 void dma_accel_set_input_buf(dma_accel_t* p_dma_accel_inst, void* p_input_buf) {
     p_dma_accel_inst->p_input_buf = p_input_buf;
 }
@@ -297,47 +693,260 @@ int dma_accel_get_sample_size_bytes(dma_accel_t* p_dma_accel_inst) {
     return (p_dma_accel_inst->sample_size_bytes);
 }
 
-int dma_accel_transfer(dma_accel_t* p_dma_accel_inst) {
+void dma_accel_set_completion_mode(dma_accel_t* p_dma_accel_inst, dma_accel_completion_mode_t mode) {
+    p_dma_accel_inst->completion_mode = mode;
+}
 
-    const int num_bytes = p_dma_accel_inst->buf_length*p_dma_accel_inst->sample_size_bytes;
+dma_accel_completion_mode_t dma_accel_get_completion_mode(dma_accel_t* p_dma_accel_inst) {
+    return (p_dma_accel_inst->completion_mode);
+}
 
-    // flush cache
-    Xil_DCacheFlushRange((int)p_dma_accel_inst->p_input_buf, num_bytes);
-    Xil_DCacheFlushRange((int)p_dma_accel_inst->p_output_buf, num_bytes);
+void dma_accel_set_queue_depth(dma_accel_t* p_dma_accel_inst, int queue_depth) {
+    p_dma_accel_inst->queue_depth = queue_depth;
+}
 
-    // initialize control flags which get set by ISRs. Should be a better way to do this...
-    g_s2mm_done = 0;
-    g_mm2s_done = 0;
-    g_dma_err   = 0;
+int dma_accel_get_queue_depth(dma_accel_t* p_dma_accel_inst) {
+    return (p_dma_accel_inst->queue_depth);
+}
 
-    // MM2S transfer
-    int status = XAxiDma_SimpleTransfer(&p_dma_accel_inst->periphs.dma_inst, (int)p_dma_accel_inst->p_input_buf, num_bytes, XAXIDMA_DMA_TO_DEVICE);
-    
-    if (status != DMA_ACCEL_SUCCESS) {
-        xil_printf("ERROR! Failed to kick off MM2S transfer!\n\r");
-        return DMA_ACCEL_TRANSFER_FAIL;
+dma_accel_completion_mode_t dma_accel_select_completion_mode(int num_bytes, int queue_depth) {
+
+    // short frames finish faster than an interrupt can be taken, so just spin on the status registers
+    if (num_bytes <= DMA_ACCEL_POLLED_MAX_BYTES) {
+        return DMA_ACCEL_COMPLETION_POLLED;
     }
 
-    // S2MM transfer
-    status = XAxiDma_SimpleTransfer( &p_dma_accel_inst->periphs.dma_inst, (int)p_dma_accel_inst->p_output_buf, num_bytes, XAXIDMA_DEVICE_TO_DMA);
+    // with more frames queued, one interrupt per frame is enough to keep the engine fed
+    if (queue_depth > 1) {
+        return DMA_ACCEL_COMPLETION_COALESCED;
+    }
 
-    if (status != DMA_ACCEL_SUCCESS) {
-        xil_printf("ERROR! Failed to kick off MM2S transfer!\n\r");
+    return DMA_ACCEL_COMPLETION_INTERRUPT;
+
+}
+
+void dma_accel_set_max_retries(dma_accel_t* p_dma_accel_inst, int max_retries) {
+    p_dma_accel_inst->max_retries = max_retries;
+}
+
+int dma_accel_get_max_retries(dma_accel_t* p_dma_accel_inst) {
+    return (p_dma_accel_inst->max_retries);
+}
+
+void dma_accel_get_fault_stats(dma_accel_t* p_dma_accel_inst, dma_accel_fault_stats_t* p_stats) {
+    *p_stats = p_dma_accel_inst->fault_stats;
+}
+
+void dma_accel_reset_fault_stats(dma_accel_t* p_dma_accel_inst) {
+    p_dma_accel_inst->fault_stats.num_faults         = 0;
+    p_dma_accel_inst->fault_stats.num_recoveries     = 0;
+    p_dma_accel_inst->fault_stats.num_resubmits      = 0;
+    p_dma_accel_inst->fault_stats.num_lost           = 0;
+    p_dma_accel_inst->fault_stats.last_recovery_ticks = 0;
+    p_dma_accel_inst->fault_stats.max_recovery_ticks = 0;
+}
+
+void dma_accel_print_fault_stats(dma_accel_t* p_dma_accel_inst) {
+    dma_accel_fault_stats_t* p_stats = &p_dma_accel_inst->fault_stats;
+    xil_printf("faults        = %d\n\r", p_stats->num_faults);
+    xil_printf("recoveries    = %d\n\r", p_stats->num_recoveries);
+    xil_printf("resubmits     = %d\n\r", p_stats->num_resubmits);
+    xil_printf("lost frames   = %d\n\r", p_stats->num_lost);
+    xil_printf("last recovery = %d us\n\r", (int)((p_stats->last_recovery_ticks*1000000)/COUNTS_PER_SECOND));
+    xil_printf("max recovery  = %d us\n\r", (int)((p_stats->max_recovery_ticks*1000000)/COUNTS_PER_SECOND));
+}
+
+#ifdef DMA_ACCEL_FAULT_INJECTION
+void dma_accel_inject_fault(dma_accel_t* p_dma_accel_inst, int num_faults) {
+    p_dma_accel_inst->inject_faults = num_faults;
+}
+#endif
+
+int dma_accel_submit(dma_accel_t* p_dma_accel_inst, unsigned int* p_id) {
+
+    dma_accel_xfer_t* p_xfer = &p_dma_accel_inst->xfer;
+
+    // direct register mode: one frame at a time
+    if (p_xfer->pending != 0) {
+        return DMA_ACCEL_BUSY;
+    }
+
+    // engines from dma_accel_create_ex finish coming out of reset on first use
+    if (!p_dma_accel_inst->ready) {
+        int status = dma_accel_wait_ready(p_dma_accel_inst, DMA_ACCEL_RESET_TIMEOUT_US);
+        if (status != DMA_ACCEL_SUCCESS) {
+            return status;
+        }
+    }
+
+    // a fault nobody recovered from yet. Bring the engine back before using it
+    if (p_dma_accel_inst->fault_pending) {
+        int status = dma_accel_recover(p_dma_accel_inst);
+        if (status != DMA_ACCEL_SUCCESS) {
+            return status;
+        }
+    }
+
+    p_xfer->id            = p_dma_accel_inst->next_id++;
+    p_xfer->p_input_buf   = p_dma_accel_inst->p_input_buf;
+    p_xfer->p_output_buf  = p_dma_accel_inst->p_output_buf;
+    p_xfer->num_bytes     = p_dma_accel_inst->buf_length*p_dma_accel_inst->sample_size_bytes;
+    p_xfer->in_place      = (p_xfer->p_input_buf == p_xfer->p_output_buf);
+    p_xfer->retries       = 0;
+
+    if (p_id != NULL) {
+        *p_id = p_xfer->id;
+    }
+
+    return start_xfer(p_dma_accel_inst);
+
+}
+
+int dma_accel_recover(dma_accel_t* p_dma_accel_inst) {
+
+    XAxiDma*           p_dma_inst = &p_dma_accel_inst->periphs.dma_inst;
+    completion_entry_t stale[4];
+    XTime              now;
+    int                reset_done = 0;
+
+    // reset clears both channels and their interrupt enables
+    XAxiDma_Reset(p_dma_inst);
+    for (int i = 0; i < RESET_TIMEOUT_COUNTER; i++) {
+        if (XAxiDma_ResetIsDone(p_dma_inst)) {
+            reset_done = 1;
+            break;
+        }
+    }
+
+    if (!reset_done) {
+        xil_printf("ERROR! AXI DMA did not come out of reset.\n\r");
+        return DMA_ACCEL_RECOVERY_FAIL;
+    }
+
+    // the engine is quiet now. Anything still in the ring belongs to the aborted attempt
+    while (completion_ring_pop(&p_dma_accel_inst->completions, stale, 4) > 0) {
+        // discard
+    }
+
+    // interrupts get re-enabled for the right mode on the next submit
+    p_dma_accel_inst->active_mode   = DMA_ACCEL_COMPLETION_ADAPTIVE;
+    p_dma_accel_inst->xfer.pending  = 0;
+
+    XTime_GetTime(&now);
+    if (p_dma_accel_inst->fault_pending) {
+        unsigned long long ticks = now - p_dma_accel_inst->fault_time;
+        p_dma_accel_inst->fault_stats.last_recovery_ticks = ticks;
+        if (ticks > p_dma_accel_inst->fault_stats.max_recovery_ticks) {
+            p_dma_accel_inst->fault_stats.max_recovery_ticks = ticks;
+        }
+    }
+    p_dma_accel_inst->fault_stats.num_recoveries++;
+    p_dma_accel_inst->fault_pending = 0;
+
+    return DMA_ACCEL_SUCCESS;
+
+}
+
+int dma_accel_resubmit(dma_accel_t* p_dma_accel_inst) {
+
+    dma_accel_xfer_t* p_xfer = &p_dma_accel_inst->xfer;
+
+    if (p_dma_accel_inst->fault_pending || (p_xfer->pending != 0)) {
+        int status = dma_accel_recover(p_dma_accel_inst);
+        if (status != DMA_ACCEL_SUCCESS) {
+            return status;
+        }
+    }
+
+    // in-place frames that were already being written back have lost their input
+    if (p_xfer->in_place && p_xfer->writeback_started) {
+        p_dma_accel_inst->fault_stats.num_lost++;
         return DMA_ACCEL_TRANSFER_FAIL;
     }
 
-    // wait for transfer to complete
-    while (!(g_s2mm_done && g_mm2s_done) && !g_dma_err) {
-        // dumb busy waiting. With better code you could do smth useful here
+    p_xfer->retries++;
+    p_dma_accel_inst->fault_stats.num_resubmits++;
+
+    return start_xfer(p_dma_accel_inst);
+
+}
+
+int dma_accel_poll_completions(dma_accel_t* p_dma_accel_inst, completion_entry_t* p_entries, int max_entries) {
+
+    poll_hardware(p_dma_accel_inst);
+
+    int n = completion_ring_pop(&p_dma_accel_inst->completions, p_entries, max_entries);
+    for (int i = 0; i < n; i++) {
+        retire_completion(p_dma_accel_inst, &p_entries[i]);
+    }
+
+    return n;
+
+}
+
+int dma_accel_is_busy(dma_accel_t* p_dma_accel_inst) {
+    return (p_dma_accel_inst->xfer.pending != 0);
+}
+
+int dma_accel_check(dma_accel_t* p_dma_accel_inst, unsigned int id) {
+
+    dma_accel_xfer_t*  p_xfer = &p_dma_accel_inst->xfer;
+    completion_entry_t entries[4];
+
+    if (p_xfer->pending != 0) {
+        dma_accel_poll_completions(p_dma_accel_inst, entries, 4);
     }
 
-    // verify no dma error
-    if (g_dma_err) {
-        xil_printf("ERROR! AXI DMA returned an error during the MM2S transfer.\n\r");
+    if (p_xfer->pending != 0) {
+        return DMA_ACCEL_BUSY;
+    }
+
+    if (!p_xfer->failed || (p_xfer->id != id)) {
+        return DMA_ACCEL_SUCCESS;
+    }
+
+    // transient fault: reset the engine and send the same frame again
+    if (p_xfer->retries >= p_dma_accel_inst->max_retries) {
+        xil_printf("ERROR! AXI DMA transfer %d failed after %d retries.\n\r", id, p_xfer->retries);
+        p_dma_accel_inst->fault_stats.num_lost++;
+        p_xfer->failed = 0; // reported once
         return DMA_ACCEL_TRANSFER_FAIL;
     }
 
-    return DMA_ACCEL_SUCCESS;
+    int status = dma_accel_resubmit(p_dma_accel_inst);
+    if (status != DMA_ACCEL_SUCCESS) {
+        xil_printf("ERROR! Failed to resubmit AXI DMA transfer %d after a fault.\n\r", id);
+        p_xfer->failed = 0;
+        return status;
+    }
+
+    return DMA_ACCEL_BUSY;
 
 }
 
+int dma_accel_wait(dma_accel_t* p_dma_accel_inst, unsigned int id) {
+
+    int status;
+
+    TRACE_BEGIN(TRACE_EV_WAIT, TRACE_TRACK_CPU, id);
+    do {
+        status = dma_accel_check(p_dma_accel_inst, id);
+    } while (status == DMA_ACCEL_BUSY);
+    TRACE_END(TRACE_EV_WAIT, TRACE_TRACK_CPU, id);
+
+    return status;
+
+}
+
+int dma_accel_transfer(dma_accel_t* p_dma_accel_inst) {
+
+    unsigned int id;
+
+    int status = dma_accel_submit(p_dma_accel_inst, &id);
+    if (status != DMA_ACCEL_SUCCESS) {
+        return status;
+    }
+
+    return dma_accel_wait(p_dma_accel_inst, id);
+
+}
@@ -1,19 +1,78 @@
 #ifndef DMA_ACCEL_H
 #define DMA_ACCEL_H
 
+#include "completion_ring.h"
+
 // return flags
 #define DMA_ACCEL_SUCCESS           0
 #define DMA_ACCEL_DMA_INIT_FAIL    -1
 #define DMA_ACCEL_INTC_INIT_FAIL   -2
 #define DMA_ACCEL_TRANSFER_FAIL    -3
+#define DMA_ACCEL_BUSY             -4
+#define DMA_ACCEL_RECOVERY_FAIL    -5
+
+// cortex-a9 l1/l2 line size. Buffers the dma touches must not share a line with
+// anything else or a flush/invalidate of the buffer would clobber it
+#define DMA_ACCEL_BUF_ALIGN         32
+
+// times a frame is resubmitted after a dma fault before dma_accel_wait gives up
+#define DMA_ACCEL_DEFAULT_MAX_RETRIES 3
+
+// longest an engine may take to come out of reset at bring-up
+#define DMA_ACCEL_RESET_TIMEOUT_US  1000
+
+// define DMA_ACCEL_FAULT_INJECTION to build in dma_accel_inject_fault
+
+// channel of a completion entry
+#define DMA_ACCEL_CHANNEL_MM2S      0
+#define DMA_ACCEL_CHANNEL_S2MM      1
+
+// frames up to this size are completed by polling when the adaptive policy is used
+#define DMA_ACCEL_POLLED_MAX_BYTES 256
+
+// how the end of a transfer is detected
+typedef enum
+{
+    DMA_ACCEL_COMPLETION_INTERRUPT = 0, // completion interrupt from each channel
+    DMA_ACCEL_COMPLETION_COALESCED = 1, // single S2MM completion interrupt per frame
+    DMA_ACCEL_COMPLETION_POLLED    = 2, // no interrupts, spin on the status registers
+    DMA_ACCEL_COMPLETION_ADAPTIVE  = 3  // pick one of the above per frame from size and queue depth
+} dma_accel_completion_mode_t;
+
+// fault and recovery counters. Times are in global timer ticks, from the
+// fault being seen to the engine being usable again
+typedef struct dma_accel_fault_stats
+{
+    int                num_faults;
+    int                num_recoveries;
+    int                num_resubmits;
+    int                num_lost;        // frames given up on
+    unsigned long long last_recovery_ticks;
+    unsigned long long max_recovery_ticks;
+} dma_accel_fault_stats_t;
 
 typedef struct dma_accel dma_accel_t;
 
 dma_accel_t* dma_accel_create(int dma_device_id, int intc_device_id, int s2mm_intr_id,
                               int mm2s_intr_id, int sample_size_bytes);
 
+// dma_accel_create_ex, for engines on a shared interrupt controller, is declared
+// in fft_registry.h so this header stays free of bsp types
+
 void dma_accel_free(dma_accel_t* p_dma_accel_inst);
 
+// DMA_ACCEL_BUSY while the engine is still in reset, then finishes bring-up
+int dma_accel_poll_ready(dma_accel_t* p_dma_accel_inst);
+
+// poll until ready, DMA_ACCEL_DMA_INIT_FAIL after timeout_us
+int dma_accel_wait_ready(dma_accel_t* p_dma_accel_inst, int timeout_us);
+
+// buffer suitable for dma: aligned to and padded out to whole cache lines.
+// Returns NULL if out of memory
+void* dma_accel_alloc_buf(int num_bytes);
+
+void dma_accel_free_buf(void* p_buf);
+
 void dma_accel_set_input_buf(dma_accel_t* p_dma_accel_inst, void* p_input_buf);
 
 void* dma_accel_get_input_buf(dma_accel_t* p_dma_accel_inst);
@@ -30,6 +89,62 @@ void dma_accel_set_sample_size_bytes(dma_accel_t* p_dma_accel_inst, int sample_s
 
 int dma_accel_get_sample_size_bytes(dma_accel_t* p_dma_accel_inst);
 
+void dma_accel_set_completion_mode(dma_accel_t* p_dma_accel_inst, dma_accel_completion_mode_t mode);
+
+dma_accel_completion_mode_t dma_accel_get_completion_mode(dma_accel_t* p_dma_accel_inst);
+
+// number of frames the caller has lined up. Only used by the adaptive completion policy
+void dma_accel_set_queue_depth(dma_accel_t* p_dma_accel_inst, int queue_depth);
+
+int dma_accel_get_queue_depth(dma_accel_t* p_dma_accel_inst);
+
+// completion mode the adaptive policy uses for a frame of num_bytes with queue_depth frames lined up
+dma_accel_completion_mode_t dma_accel_select_completion_mode(int num_bytes, int queue_depth);
+
+// start a transfer of the current buffers without waiting for it. The transfer
+// id is written to p_id (may be NULL). Returns DMA_ACCEL_BUSY if a frame is
+// still in flight. Input and output buffers may be the same (in-place); in that
+// case the S2MM write is only started once MM2S has read the whole frame.
+int dma_accel_submit(dma_accel_t* p_dma_accel_inst, unsigned int* p_id);
+
+// drain up to max_entries completions (one per channel per transfer) from the
+// ring written by the ISRs. Returns the number of entries copied out
+int dma_accel_poll_completions(dma_accel_t* p_dma_accel_inst, completion_entry_t* p_entries, int max_entries);
+
+int dma_accel_is_busy(dma_accel_t* p_dma_accel_inst);
+
+// non-blocking: DMA_ACCEL_BUSY while transfer id is in flight (including a
+// resubmission after a fault), then its final status once
+int dma_accel_check(dma_accel_t* p_dma_accel_inst, unsigned int id);
+
+// block until transfer id has completed on both channels, resubmitting it
+// after a fault up to the max retries
+int dma_accel_wait(dma_accel_t* p_dma_accel_inst, unsigned int id);
+
+// reset the engine after a fault, outside interrupt context, and throw away
+// completions of the aborted attempt. Interrupts are re-armed on the next submit
+int dma_accel_recover(dma_accel_t* p_dma_accel_inst);
+
+// recover if needed and send the last submitted frame again under the same id.
+// Fails for in-place frames whose write-back had already started
+int dma_accel_resubmit(dma_accel_t* p_dma_accel_inst);
+
+void dma_accel_set_max_retries(dma_accel_t* p_dma_accel_inst, int max_retries);
+
+int dma_accel_get_max_retries(dma_accel_t* p_dma_accel_inst);
+
+void dma_accel_get_fault_stats(dma_accel_t* p_dma_accel_inst, dma_accel_fault_stats_t* p_stats);
+
+void dma_accel_reset_fault_stats(dma_accel_t* p_dma_accel_inst);
+
+void dma_accel_print_fault_stats(dma_accel_t* p_dma_accel_inst);
+
+#ifdef DMA_ACCEL_FAULT_INJECTION
+// report the next num_faults channel completions as errors
+void dma_accel_inject_fault(dma_accel_t* p_dma_accel_inst, int num_faults);
+#endif
+
+// blocking submit + wait. Transient faults are recovered from and the frame resubmitted
 int dma_accel_transfer(dma_accel_t* p_dma_accel_inst);
 
 #endif // DMA_ACCEL_H
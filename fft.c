@@ -1,6 +1,10 @@
 #include <stdlib.h>
+#include <math.h>
 #include "fft.h"
+#include "fft_registry.h"
+#include "trace.h"
 #include "xgpio.h"
+#include "xtime_l.h"
 
 typedef struct fft_periphs {
     dma_accel_t* p_dma_accel_inst;
@@ -8,10 +12,21 @@ typedef struct fft_periphs {
 } fft_periphs_t;
 
 typedef struct fft {
-    fft_periphs_t periphs;
-    fft_fwd_inv_t fwd_inv;
-    int           num_pts;
-    int           scale_sch;
+    fft_periphs_t      periphs;
+    int                arch;
+    fft_fwd_inv_t      fwd_inv;
+    int                num_pts;
+    int                log2_num_pts;    // config word field, kept with num_pts
+    int                scale_sch;
+    unsigned int       xfer_id;         // dma transfer started by fft_start
+    complex_sample_t*  p_stage;         // fft_format conversion frame, allocated on first use
+    complex_sample_t*  p_dout;          // output of the transform started by fft_start
+    int                out_num_pts;     // and its size and direction, the params may change before it's polled
+    fft_fwd_inv_t      out_fwd_inv;
+    int                output_pending;  // output hook not yet run for it
+    fft_output_fn      output_fn;
+    void*              p_output_ctx;
+    unsigned long long first_done_time; // global timer at the end of the first transform, 0 before
 } fft_t;
 
 static int is_power_of_2(int x) {
@@ -32,6 +47,11 @@ static int floor_log2(int x) {
     return log2_N;
 }
 
+// scale value applied in a given stage of a schedule
+static int stage_scale(int scale_sch, int stage) {
+    return (scale_sch >> (2*stage)) & 0x3;
+}
+
 static int init_gpio(XGpio* p_gpio_inst, int gpio_device_id) {
     // init driver
     int status = XGpio_Initialize(p_gpio_inst, gpio_device_id);
@@ -47,16 +67,19 @@ static int init_gpio(XGpio* p_gpio_inst, int gpio_device_id) {
 
 static void fft_commit_params(fft_t* p_fft_inst) {
 
+    TRACE_BEGIN(TRACE_EV_COMMIT_PARAMS, TRACE_TRACK_CPU, p_fft_inst->num_pts);
+
     int reg  = (p_fft_inst->scale_sch         << FFT_SCALE_SCH_SHIFT) & FFT_SCALE_SCH_MASK;
     reg |= (p_fft_inst->fwd_inv           << FFT_FWD_INV_SHIFT)   & FFT_FWD_INV_MASK;
-    reg |= (floor_log2(p_fft_inst->num_pts) << FFT_NUM_PTS_SHIFT)   & FFT_NUM_PTS_MASK;
+    reg |= (p_fft_inst->log2_num_pts      << FFT_NUM_PTS_SHIFT)   & FFT_NUM_PTS_MASK;
 
     XGpio_DiscreteWrite(&p_fft_inst->periphs.gpio_inst, 1, reg);
 
+    TRACE_END(TRACE_EV_COMMIT_PARAMS, TRACE_TRACK_CPU, p_fft_inst->num_pts);
+
 }
 
-// Public functions
-fft_t* fft_create(int gpio_device_id, int dma_device_id, int intc_device_id, int s2mm_intr_id, int mm2s_intr_id) {
+static fft_t* alloc_fft(void) {
 
     // Allocate memory for FFT object
     fft_t* p_obj = (fft_t*) malloc(sizeof(fft_t));
@@ -65,8 +88,19 @@ fft_t* fft_create(int gpio_device_id, int dma_device_id, int intc_device_id, int
         return NULL;
     }
 
-    // create dma accelerator that will be used to compute fft
-    p_obj->periphs.p_dma_accel_inst = dma_accel_create(dma_device_id, intc_device_id, s2mm_intr_id, mm2s_intr_id, sizeof(complex_sample_t));
+    p_obj->p_stage         = NULL;
+    p_obj->p_dout          = NULL;
+    p_obj->output_pending  = 0;
+    p_obj->output_fn       = NULL;
+    p_obj->p_output_ctx    = NULL;
+    p_obj->first_done_time = 0;
+
+    return p_obj;
+
+}
+
+// everything after the dma accelerator, the same for both create variants
+static fft_t* init_fft(fft_t* p_obj, int gpio_device_id, int num_pts) {
 
     if (p_obj->periphs.p_dma_accel_inst == NULL) {
         xil_printf("ERROR! Failed to create DMA Accelerator object for use by the FFT engine.\n\r");
@@ -82,22 +116,68 @@ fft_t* fft_create(int gpio_device_id, int dma_device_id, int intc_device_id, int
         return NULL;
     }
 
-    // init fft parameters
+    // init fft parameters. The scale schedule follows from architecture and size
+    p_obj->arch = FFT_DEFAULT_ARCH;
     fft_set_fwd_inv(p_obj, FFT_FORWARD);
-    status = fft_set_num_pts(p_obj, 1024);
+    status = fft_set_num_pts(p_obj, num_pts);
     if (status != FFT_SUCCESS) {
         xil_printf("ERROR! Failed to initialize the number of points in the FFT.\n\r");
         fft_destroy(p_obj);
         return NULL;
     }
-    fft_set_scale_sch(p_obj, 0x2AB);
 
     return p_obj;
 
 }
 
+// Public functions
+fft_t* fft_create(int gpio_device_id, int dma_device_id, int intc_device_id, int s2mm_intr_id, int mm2s_intr_id) {
+
+    fft_t* p_obj = alloc_fft();
+    if (p_obj == NULL) {
+        return NULL;
+    }
+
+    // create dma accelerator that will be used to compute fft
+    p_obj->periphs.p_dma_accel_inst = dma_accel_create(dma_device_id, intc_device_id, s2mm_intr_id, mm2s_intr_id, sample_format_bytes(FFT_CORE_FORMAT));
+
+    return init_fft(p_obj, gpio_device_id, 1024);
+
+}
+
+fft_t* fft_create_ex(int gpio_device_id, int dma_device_id, XScuGic* p_intc_inst, int s2mm_intr_id, int mm2s_intr_id, int num_pts) {
+
+    fft_t* p_obj = alloc_fft();
+    if (p_obj == NULL) {
+        return NULL;
+    }
+
+    p_obj->periphs.p_dma_accel_inst = dma_accel_create_ex(dma_device_id, p_intc_inst, s2mm_intr_id, mm2s_intr_id, sample_format_bytes(FFT_CORE_FORMAT));
+
+    return init_fft(p_obj, gpio_device_id, num_pts);
+
+}
+
+int fft_poll_ready(fft_t* p_fft_inst) {
+    int status = dma_accel_poll_ready(p_fft_inst->periphs.p_dma_accel_inst);
+    if (status == DMA_ACCEL_BUSY) {
+        return FFT_BUSY;
+    }
+    return (status == DMA_ACCEL_SUCCESS) ? FFT_SUCCESS : FFT_DMA_FAIL;
+}
+
+int fft_wait_ready(fft_t* p_fft_inst, int timeout_us) {
+    int status = dma_accel_wait_ready(p_fft_inst->periphs.p_dma_accel_inst, timeout_us);
+    return (status == DMA_ACCEL_SUCCESS) ? FFT_SUCCESS : FFT_DMA_FAIL;
+}
+
+unsigned long long fft_get_first_done_time(fft_t* p_fft_inst) {
+    return (p_fft_inst->first_done_time);
+}
+
 void fft_destroy(fft_t* p_fft_inst) {
     dma_accel_free(p_fft_inst->periphs.p_dma_accel_inst);
+    dma_accel_free_buf(p_fft_inst->p_stage);
     free(p_fft_inst);
 }
 
@@ -113,11 +193,19 @@ int fft_set_num_pts(fft_t* p_fft_inst, int num_pts) {
     if (num_pts > FFT_MAX_NUM_PTS) {
         xil_printf("ERROR! Attempted to set too large number of points in the FFT.\n\r");
         return FFT_ILLEGAL_NUM_PTS;
+    } else if (num_pts < FFT_MIN_NUM_PTS) {
+        xil_printf("ERROR! Attempted to set too small number of points in the FFT.\n\r");
+        return FFT_ILLEGAL_NUM_PTS;
     } else if (!is_power_of_2(num_pts)) {
         xil_printf("ERROR! Attempted to set a non-power-of-2 value for the number of points in the FFT.\n\r");
         return FFT_ILLEGAL_NUM_PTS;
+    } else if (fft_scale_sch_num_stages(p_fft_inst->arch, num_pts)*2 > FFT_SCALE_SCH_WIDTH) {
+        xil_printf("ERROR! The scale schedule for a %d-point FFT doesn't fit in the config word for this architecture.\n\r", num_pts);
+        return FFT_ILLEGAL_NUM_PTS;
     } else {
         p_fft_inst->num_pts = num_pts;
+        p_fft_inst->log2_num_pts = floor_log2(num_pts);
+        p_fft_inst->scale_sch = fft_default_scale_sch(p_fft_inst->arch, num_pts);
         dma_accel_set_buf_length(p_fft_inst->periphs.p_dma_accel_inst, p_fft_inst->num_pts);
         return FFT_SUCCESS;
     }
@@ -127,16 +215,198 @@ int fft_get_num_pts(fft_t* p_fft_inst) {
     return (p_fft_inst->num_pts);
 }
 
-void fft_set_scale_sch(fft_t* p_fft_inst, int scale_sch) {
+int fft_ensure_config(fft_t* p_fft_inst, int num_pts, fft_fwd_inv_t fwd_inv) {
+    if (p_fft_inst->num_pts != num_pts) {
+        int status = fft_set_num_pts(p_fft_inst, num_pts);
+        if (status != FFT_SUCCESS) {
+            return status;
+        }
+    }
+    fft_set_fwd_inv(p_fft_inst, fwd_inv);
+    return FFT_SUCCESS;
+}
+
+int fft_set_arch(fft_t* p_fft_inst, int arch) {
+    if ((arch < FFT_ARCH_PIPELINED) || (arch > FFT_ARCH_RADIX2_LITE)) {
+        xil_printf("ERROR! Unknown FFT architecture %d.\n\r", arch);
+        return FFT_ILLEGAL_ARCH;
+    } else if (fft_scale_sch_num_stages(arch, p_fft_inst->num_pts)*2 > FFT_SCALE_SCH_WIDTH) {
+        xil_printf("ERROR! The scale schedule for a %d-point FFT doesn't fit in the config word for this architecture.\n\r", p_fft_inst->num_pts);
+        return FFT_ILLEGAL_ARCH;
+    } else {
+        p_fft_inst->arch      = arch;
+        p_fft_inst->scale_sch = fft_default_scale_sch(arch, p_fft_inst->num_pts);
+        return FFT_SUCCESS;
+    }
+}
+
+int fft_get_arch(fft_t* p_fft_inst) {
+    return (p_fft_inst->arch);
+}
+
+int fft_set_scale_sch(fft_t* p_fft_inst, int scale_sch) {
+    int status = fft_validate_scale_sch(p_fft_inst->arch, p_fft_inst->num_pts, scale_sch);
+    if (status != FFT_SUCCESS) {
+        xil_printf("ERROR! Scale schedule 0x%X is not legal for a %d-point FFT on this architecture.\n\r", scale_sch, p_fft_inst->num_pts);
+        return status;
+    }
+
     p_fft_inst->scale_sch = scale_sch;
+    return FFT_SUCCESS;
 }
 
 int fft_get_scale_sch(fft_t* p_fft_inst) {
     return (p_fft_inst->scale_sch);
 }
 
+int fft_get_scale_shift(fft_t* p_fft_inst) {
+    int shift      = 0;
+    int num_stages = fft_scale_sch_num_stages(p_fft_inst->arch, p_fft_inst->num_pts);
+    for (int stage = 0; stage < num_stages; stage++) {
+        shift += stage_scale(p_fft_inst->scale_sch, stage);
+    }
+    return shift;
+}
+
+int fft_scale_sch_num_stages(int arch, int num_pts) {
+    int log2_N = floor_log2(num_pts);
+
+    if ((arch == FFT_ARCH_RADIX2) || (arch == FFT_ARCH_RADIX2_LITE)) {
+        return log2_N;
+    }
+
+    // pipelined and radix-4 group stages in pairs, with a trailing radix-2 stage for odd sizes
+    return (log2_N + 1) / 2;
+}
+
+int fft_validate_scale_sch(int arch, int num_pts, int scale_sch) {
+    int num_stages = fft_scale_sch_num_stages(arch, num_pts);
+
+    if ((scale_sch < 0) || (num_stages*2 > FFT_SCALE_SCH_WIDTH)) {
+        return FFT_ILLEGAL_SCALE_SCH;
+    }
+
+    // nothing may be set above the last stage
+    if ((scale_sch >> (2*num_stages)) != 0) {
+        return FFT_ILLEGAL_SCALE_SCH;
+    }
+
+    // a trailing radix-2 stage grows by at most one bit
+    if ((arch == FFT_ARCH_PIPELINED || arch == FFT_ARCH_RADIX4) && (floor_log2(num_pts) % 2 == 1)) {
+        if (stage_scale(scale_sch, num_stages - 1) > 1) {
+            return FFT_ILLEGAL_SCALE_SCH;
+        }
+    }
+
+    return FFT_SUCCESS;
+}
+
+int fft_default_scale_sch(int arch, int num_pts) {
+    int num_stages = fft_scale_sch_num_stages(arch, num_pts);
+    int scale_sch  = 0;
+
+    for (int stage = 0; stage < num_stages; stage++) {
+        int scale;
+        if ((arch == FFT_ARCH_RADIX2) || (arch == FFT_ARCH_RADIX2_LITE)) {
+            // radix-2 butterflies grow by one bit, plus one extra in the first stage
+            scale = (stage == 0) ? 2 : 1;
+        } else if ((stage == num_stages - 1) && (floor_log2(num_pts) % 2 == 1)) {
+            scale = 1;
+        } else {
+            // radix-4 butterflies grow by two bits, plus one extra in the first stage
+            scale = (stage == 0) ? 3 : 2;
+        }
+        scale_sch |= scale << (2*stage);
+    }
+
+    return scale_sch;
+}
+
 int fft(fft_t* p_fft_inst, complex_sample_t* din, complex_sample_t* dout) {
 
+    int status = fft_start(p_fft_inst, din, dout);
+    if (status != FFT_SUCCESS) {
+        return status;
+    }
+
+    return fft_wait(p_fft_inst);
+}
+
+int fft_batch(fft_t* p_fft_inst, complex_sample_t* din, complex_sample_t* dout, int num_frames) {
+
+    for (int f = 0; f < num_frames; f++) {
+        // let the dma see how many frames are still lined up
+        fft_set_queue_depth(p_fft_inst, num_frames - f - 1);
+
+        int status = fft(p_fft_inst, &din[f * p_fft_inst->num_pts], &dout[f * p_fft_inst->num_pts]);
+        if (status != FFT_SUCCESS) {
+            return status;
+        }
+    }
+
+    return FFT_SUCCESS;
+}
+
+int fft_format(fft_t* p_fft_inst, sample_format_id_t in_fmt, const void* din, sample_format_id_t out_fmt, void* dout, float in_scale, int* p_block_exp) {
+
+    if ((sample_format_get(in_fmt) == NULL) || (sample_format_get(out_fmt) == NULL)) {
+        xil_printf("ERROR! Unknown sample format.\n\r");
+        return FFT_ILLEGAL_FORMAT;
+    }
+
+    if ((p_fft_inst->p_stage == NULL) && ((in_fmt != FFT_CORE_FORMAT) || (out_fmt != FFT_CORE_FORMAT))) {
+        p_fft_inst->p_stage = (complex_sample_t*) dma_accel_alloc_buf(sizeof(complex_sample_t)*FFT_MAX_NUM_PTS);
+        if (p_fft_inst->p_stage == NULL) {
+            xil_printf("ERROR! Failed to allocate memory for the FFT staging frame.\n\r");
+            return FFT_ALLOC_FAIL;
+        }
+    }
+
+    int               num_pts   = p_fft_inst->num_pts;
+    int               block_exp = 0;
+    complex_sample_t* p_in      = p_fft_inst->p_stage;
+    complex_sample_t* p_out     = (out_fmt == FFT_CORE_FORMAT) ? (complex_sample_t*)dout : p_fft_inst->p_stage;
+
+    // convert on the way into the frame, core format goes to the engine as is
+    if (in_fmt == SAMPLE_FORMAT_CF32) {
+        sample_format_cf32_to_ci16(p_in, (const float*)din, num_pts, in_scale);
+    } else if (in_fmt == SAMPLE_FORMAT_CI32) {
+        // a frame of ints is at most 64 KB, so the scan leaves it in L2 and the
+        // conversion pass doesn't go back to ddr
+        block_exp = sample_format_ci32_block_exp((const int*)din, num_pts);
+        sample_format_ci32_to_ci16(p_in, (const int*)din, num_pts, block_exp);
+        in_scale  = 1.0f;
+    } else {
+        p_in     = (complex_sample_t*)din;
+        in_scale = 1.0f;
+    }
+
+    int status = fft(p_fft_inst, p_in, p_out);
+    if (status != FFT_SUCCESS) {
+        return status;
+    }
+
+    int shift = fft_get_scale_shift(p_fft_inst) + block_exp;
+
+    if (out_fmt == SAMPLE_FORMAT_CF32) {
+        sample_format_ci16_to_cf32((float*)dout, p_out, num_pts, ldexpf(1.0f, shift) / in_scale);
+    } else if (out_fmt == SAMPLE_FORMAT_CI32) {
+        sample_format_ci16_to_ci32((int*)dout, p_out, num_pts, shift);
+    }
+
+    if (p_block_exp != NULL) {
+        *p_block_exp = block_exp;
+    }
+
+    return FFT_SUCCESS;
+}
+
+int fft_start(fft_t* p_fft_inst, complex_sample_t* din, complex_sample_t* dout) {
+
+    if (dma_accel_is_busy(p_fft_inst->periphs.p_dma_accel_inst)) {
+        return FFT_BUSY;
+    }
+
     // commit struct parameters to hardware
     fft_commit_params(p_fft_inst);
 
@@ -145,15 +415,70 @@ int fft(fft_t* p_fft_inst, complex_sample_t* din, complex_sample_t* dout) {
     dma_accel_set_output_buf(p_fft_inst->periphs.p_dma_accel_inst, (void*)dout);
 
     // dma transfer
-    status = dma_accel_transfer(p_fft_inst->periphs.p_dma_accel_inst);
+    int status = dma_accel_submit(p_fft_inst->periphs.p_dma_accel_inst, &p_fft_inst->xfer_id);
     if (status != DMA_ACCEL_SUCCESS) {
         xil_printf("ERROR! DMA transfer failed.\n\r");
         return FFT_DMA_FAIL;
     }
 
+    p_fft_inst->p_dout         = dout;
+    p_fft_inst->out_num_pts    = p_fft_inst->num_pts;
+    p_fft_inst->out_fwd_inv    = p_fft_inst->fwd_inv;
+    p_fft_inst->output_pending = 1;
+
     return FFT_SUCCESS;
 }
 
+int fft_poll(fft_t* p_fft_inst) {
+
+    int status = dma_accel_check(p_fft_inst->periphs.p_dma_accel_inst, p_fft_inst->xfer_id);
+    if (status == DMA_ACCEL_BUSY) {
+        return FFT_BUSY;
+    } else if (status != DMA_ACCEL_SUCCESS) {
+        p_fft_inst->output_pending = 0;
+        xil_printf("ERROR! DMA transfer failed.\n\r");
+        return FFT_DMA_FAIL;
+    }
+
+    // polling again after completion must not run the hook twice
+    if (p_fft_inst->output_pending) {
+        p_fft_inst->output_pending = 0;
+        if (p_fft_inst->first_done_time == 0) {
+            XTime now;
+            XTime_GetTime(&now);
+            p_fft_inst->first_done_time = now;
+        }
+        if (p_fft_inst->output_fn != NULL) {
+            p_fft_inst->output_fn(p_fft_inst->p_dout, p_fft_inst->out_num_pts, p_fft_inst->out_fwd_inv,
+                                  p_fft_inst->xfer_id, p_fft_inst->p_output_ctx);
+        }
+    }
+
+    return FFT_SUCCESS;
+}
+
+int fft_wait(fft_t* p_fft_inst) {
+
+    int status;
+
+    TRACE_BEGIN(TRACE_EV_WAIT, TRACE_TRACK_CPU, p_fft_inst->xfer_id);
+    do {
+        status = fft_poll(p_fft_inst);
+    } while (status == FFT_BUSY);
+    TRACE_END(TRACE_EV_WAIT, TRACE_TRACK_CPU, p_fft_inst->xfer_id);
+
+    return status;
+}
+
+void fft_set_output_hook(fft_t* p_fft_inst, fft_output_fn output_fn, void* p_ctx) {
+    p_fft_inst->output_fn    = output_fn;
+    p_fft_inst->p_output_ctx = p_ctx;
+}
+
+void fft_set_queue_depth(fft_t* p_fft_inst, int queue_depth) {
+    dma_accel_set_queue_depth(p_fft_inst->periphs.p_dma_accel_inst, queue_depth);
+}
+
 complex_sample_t* fft_get_input_buf(fft_t* p_fft_inst) {
     return (complex_sample_t*)dma_accel_get_input_buf(p_fft_inst->periphs.p_dma_accel_inst);
 }
@@ -163,6 +488,8 @@ complex_sample_t* fft_get_output_buf(fft_t* p_fft_inst) {
 }
 
 void fft_print_params(fft_t* p_fft_inst) {
+    static const char* arch_names[] = {"pipelined", "radix-4", "radix-2", "radix-2 lite"};
+    xil_printf("arch      = %s\n\r", arch_names[p_fft_inst->arch]);
     xil_printf("fwd_inv   = %s\n\r", (p_fft_inst->fwd_inv == FFT_FORWARD ? "forward" : "inverse"));
     xil_printf("num_pts   = %d\n\r", p_fft_inst->num_pts);
     xil_printf("scale_sch = 0x%X\n\r", p_fft_inst->scale_sch);
@@ -187,7 +514,7 @@ void fft_print_output_buf(fft_t* p_fft_inst) {
     complex_sample_t* tmp = (complex_sample_t*)dma_accel_get_output_buf(p_fft_inst->periphs.p_dma_accel_inst);
 
 
-    for (i = 0; i < p_fft_inst->num_pts; i++)
+    for (int i = 0; i < p_fft_inst->num_pts; i++)
     {
         complex_sample_get_string(str, tmp[i]);
         xil_printf("Xk(%d) = %s\n\r", i, str);
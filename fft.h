@@ -2,6 +2,7 @@
 #define FFT_H
 
 #include "complex_sample.h"
+#include "sample_format.h"
 #include "dma_accel.h"
 
 #define FFT_ARCH_PIPELINED   0
@@ -9,6 +10,7 @@
 #define FFT_ARCH_RADIX2      2
 #define FFT_ARCH_RADIX2_LITE 3
 
+#define FFT_MIN_NUM_PTS      8
 #define FFT_MAX_NUM_PTS      8192
 #define FFT_NUM_PTS_MASK     0x0000001F // Bits [4:0]
 #define FFT_NUM_PTS_SHIFT    0
@@ -16,11 +18,23 @@
 #define FFT_FWD_INV_SHIFT    8
 #define FFT_SCALE_SCH_MASK   0x007FFE00 // Bits [22:9]
 #define FFT_SCALE_SCH_SHIFT  9
+#define FFT_SCALE_SCH_WIDTH  14         // bits available for the schedule in the config word
 
 #define FFT_SUCCESS          0
 #define FFT_GPIO_INIT_FAIL  -1
 #define FFT_ILLEGAL_NUM_PTS -2
 #define FFT_DMA_FAIL        -3
+#define FFT_ILLEGAL_SCALE_SCH -4
+#define FFT_ILLEGAL_ARCH    -5
+#define FFT_BUSY            -6
+#define FFT_ILLEGAL_FORMAT  -7
+#define FFT_ALLOC_FAIL      -8
+
+// architecture assumed for engines until fft_set_arch is called
+#define FFT_DEFAULT_ARCH     FFT_ARCH_PIPELINED
+
+// sample format on the core's axi streams
+#define FFT_CORE_FORMAT      SAMPLE_FORMAT_CI16
 
 typedef enum
 {
@@ -30,8 +44,26 @@ typedef enum
 
 typedef struct fft fft_t;
 
+// sees every transform's output once, from fft_poll/fft_wait in the caller's
+// context (never the isr), after the output buffer is valid in the cache. Size
+// and direction are the ones the transform was started with, inverse transforms
+// included
+typedef void (*fft_output_fn)(const complex_sample_t* p_dout, int num_pts, fft_fwd_inv_t fwd_inv, unsigned int frame_id, void* p_ctx);
+
 fft_t* fft_create(int gpio_device_id, int dma_device_id, int intc_device_id, int s2mm_intr_id, int mm2s_intr_id);
 
+// fft_create_ex, for engines on a shared interrupt controller, is declared in
+// fft_registry.h so this header stays free of bsp types (fft_service.h includes
+// it on the host)
+
+// FFT_BUSY while the engine is still coming out of reset
+int fft_poll_ready(fft_t* p_fft_inst);
+
+int fft_wait_ready(fft_t* p_fft_inst, int timeout_us);
+
+// global timer ticks at which the first transform completed, 0 if none has
+unsigned long long fft_get_first_done_time(fft_t* p_fft_inst);
+
 void fft_destroy(fft_t* p_fft_inst);
 
 void fft_set_fwd_inv(fft_t* p_fft_inst, fft_fwd_inv_t fwd_inv);
@@ -42,12 +74,70 @@ int fft_set_num_pts(fft_t* p_fft_inst, int num_pts);
 
 int fft_get_num_pts(fft_t* p_fft_inst);
 
-void fft_set_scale_sch(fft_t* p_fft_inst, int scale_sch);
+// size and direction for the next transforms, for stages that share an engine
+// and can't assume it's still set up the way they left it. The size (and with
+// it the scale schedule) is only reset if it differs. On failure the engine
+// keeps its old size, so nothing may be started into num_pts-sized buffers
+int fft_ensure_config(fft_t* p_fft_inst, int num_pts, fft_fwd_inv_t fwd_inv);
+
+// architecture of the core behind this engine. Resets the scale schedule to the
+// conservative default for the current point size
+int fft_set_arch(fft_t* p_fft_inst, int arch);
+
+int fft_get_arch(fft_t* p_fft_inst);
+
+// scale_sch holds 2 bits per stage, stage 0 in the lsbs. Pipelined and radix-4
+// cores have ceil(log2(N)/2) radix-4 stages (the last one only takes 0 or 1 when
+// log2(N) is odd), radix-2 and radix-2 lite cores have log2(N) stages
+int fft_set_scale_sch(fft_t* p_fft_inst, int scale_sch);
 
 int fft_get_scale_sch(fft_t* p_fft_inst);
 
+// total number of bits the current schedule shifts the result right by
+int fft_get_scale_shift(fft_t* p_fft_inst);
+
+// number of scaling stages for an architecture and point size
+int fft_scale_sch_num_stages(int arch, int num_pts);
+
+// FFT_SUCCESS if scale_sch is a legal schedule for arch and num_pts
+int fft_validate_scale_sch(int arch, int num_pts, int scale_sch);
+
+// conservative schedule that can't overflow for any input
+int fft_default_scale_sch(int arch, int num_pts);
+
+// din and dout may point to the same buffer to transform in place
 int fft(fft_t* p_fft_inst, complex_sample_t* din, complex_sample_t* dout);
 
+// transform num_frames back to back frames of num_pts samples each. din and dout
+// may be the same buffer
+int fft_batch(fft_t* p_fft_inst, complex_sample_t* din, complex_sample_t* dout, int num_frames);
+
+// transform samples held in any supported format. The input is converted
+// straight into an internal engine frame and the result straight out of it, so
+// each side costs one pass. cf32 input is multiplied by in_scale before rounding,
+// ci32 input gets a block exponent (returned through p_block_exp if not NULL).
+// cf32 output is scaled back to input units, undoing in_scale, the block exponent
+// and the scale schedule. ci32 output undoes the block exponent and the schedule,
+// ci16 output is the raw core output
+int fft_format(fft_t* p_fft_inst, sample_format_id_t in_fmt, const void* din, sample_format_id_t out_fmt, void* dout, float in_scale, int* p_block_exp);
+
+// start a transform without waiting for it. Returns FFT_BUSY if the engine
+// is still working on the previous one
+int fft_start(fft_t* p_fft_inst, complex_sample_t* din, complex_sample_t* dout);
+
+// FFT_BUSY while the transform started by fft_start runs, then its status
+int fft_poll(fft_t* p_fft_inst);
+
+// block until the transform started by fft_start is done
+int fft_wait(fft_t* p_fft_inst);
+
+// attach a stage to the output path, NULL to detach
+void fft_set_output_hook(fft_t* p_fft_inst, fft_output_fn output_fn, void* p_ctx);
+
+// number of frames the caller has lined up behind the current one. Lets the
+// dma pick a completion mode suited to the load
+void fft_set_queue_depth(fft_t* p_fft_inst, int queue_depth);
+
 complex_sample_t* fft_get_input_buf(fft_t* p_fft_inst);
 
 complex_sample_t* fft_get_output_buf(fft_t* p_fft_inst);
@@ -0,0 +1,227 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "xil_printf.h"
+#include "fft2d.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+// a strip is gathered while the previous one is scattered and the current one is
+// in the engine
+#define FFT2D_NUM_STRIPS  3
+
+typedef struct fft2d {
+    fft_t*            p_fft_inst;
+    int               num_rows;
+    int               num_cols;
+    fft_fwd_inv_t     fwd_inv;
+    int               row_scale_sch;
+    int               col_scale_sch;
+    complex_sample_t* p_strips[FFT2D_NUM_STRIPS]; // FFT2D_STRIP_COLS frames of num_rows samples
+} fft2d_t;
+
+// 4x4 block of samples, src rows become dst columns. Strides are in samples.
+// A sample is 32 bits, so the block is a plain 32-bit transpose
+static void transpose_4x4(const complex_sample_t* src, int src_stride, complex_sample_t* dst, int dst_stride) {
+#ifdef __ARM_NEON
+    uint32x4_t r0 = vld1q_u32((const uint32_t*)&src[0*src_stride]);
+    uint32x4_t r1 = vld1q_u32((const uint32_t*)&src[1*src_stride]);
+    uint32x4_t r2 = vld1q_u32((const uint32_t*)&src[2*src_stride]);
+    uint32x4_t r3 = vld1q_u32((const uint32_t*)&src[3*src_stride]);
+
+    uint32x4x2_t t01 = vtrnq_u32(r0, r1);
+    uint32x4x2_t t23 = vtrnq_u32(r2, r3);
+
+    vst1q_u32((uint32_t*)&dst[0*dst_stride], vcombine_u32(vget_low_u32(t01.val[0]),  vget_low_u32(t23.val[0])));
+    vst1q_u32((uint32_t*)&dst[1*dst_stride], vcombine_u32(vget_low_u32(t01.val[1]),  vget_low_u32(t23.val[1])));
+    vst1q_u32((uint32_t*)&dst[2*dst_stride], vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0])));
+    vst1q_u32((uint32_t*)&dst[3*dst_stride], vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1])));
+#else
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            dst[j*dst_stride + i] = src[i*src_stride + j];
+        }
+    }
+#endif
+}
+
+// rows [row_lo, row_hi) of the strip starting at col0, matrix to strip frames
+static void gather_strip(fft2d_t* p_fft2d_inst, const complex_sample_t* p_mat, int col0, complex_sample_t* p_strip, int row_lo, int row_hi) {
+    int C = p_fft2d_inst->num_cols;
+    int R = p_fft2d_inst->num_rows;
+
+    for (int r = row_lo; r < row_hi; r += 4) {
+        for (int c = 0; c < FFT2D_STRIP_COLS; c += 4) {
+            transpose_4x4(&p_mat[r*C + col0 + c], C, &p_strip[c*R + r], R);
+        }
+    }
+}
+
+// the reverse, strip frames back into the matrix columns
+static void scatter_strip(fft2d_t* p_fft2d_inst, complex_sample_t* p_mat, int col0, const complex_sample_t* p_strip, int row_lo, int row_hi) {
+    int C = p_fft2d_inst->num_cols;
+    int R = p_fft2d_inst->num_rows;
+
+    for (int r = row_lo; r < row_hi; r += 4) {
+        for (int c = 0; c < FFT2D_STRIP_COLS; c += 4) {
+            transpose_4x4(&p_strip[c*R + r], R, &p_mat[r*C + col0 + c], C);
+        }
+    }
+}
+
+// rows handled alongside frame f of a strip, multiples of 4 that cover all rows
+static int slice_row(fft2d_t* p_fft2d_inst, int f) {
+    return (f * p_fft2d_inst->num_rows / FFT2D_STRIP_COLS) & ~3;
+}
+
+// right shift a schedule applies on a given size
+static int sched_shift(int arch, int num_pts, int scale_sch) {
+    int shift = 0;
+    for (int stage = 0; stage < fft_scale_sch_num_stages(arch, num_pts); stage++) {
+        shift += (scale_sch >> (2*stage)) & 0x3;
+    }
+    return shift;
+}
+
+static int set_pass(fft2d_t* p_fft2d_inst, int num_pts, int scale_sch) {
+    if (fft_set_num_pts(p_fft2d_inst->p_fft_inst, num_pts) != FFT_SUCCESS) {
+        return FFT2D_FFT_FAIL;
+    }
+    if (fft_set_scale_sch(p_fft2d_inst->p_fft_inst, scale_sch) != FFT_SUCCESS) {
+        return FFT2D_FFT_FAIL;
+    }
+    fft_set_fwd_inv(p_fft2d_inst->p_fft_inst, p_fft2d_inst->fwd_inv);
+    return FFT2D_SUCCESS;
+}
+
+// Public functions
+fft2d_t* fft2d_create(fft_t* p_fft_inst, int num_rows, int num_cols) {
+
+    if ((num_rows < FFT_MIN_NUM_PTS) || (num_cols < FFT2D_STRIP_COLS) || (num_rows > FFT_MAX_NUM_PTS) || (num_cols > FFT_MAX_NUM_PTS) ||
+        ((num_rows & (num_rows - 1)) != 0) || ((num_cols & (num_cols - 1)) != 0)) {
+        xil_printf("ERROR! Illegal 2D FFT size %d x %d.\n\r", num_rows, num_cols);
+        return NULL;
+    }
+
+    int arch = fft_get_arch(p_fft_inst);
+    if ((fft_validate_scale_sch(arch, num_rows, fft_default_scale_sch(arch, num_rows)) != FFT_SUCCESS) ||
+        (fft_validate_scale_sch(arch, num_cols, fft_default_scale_sch(arch, num_cols)) != FFT_SUCCESS)) {
+        xil_printf("ERROR! The FFT engine can't run a %d x %d transform.\n\r", num_rows, num_cols);
+        return NULL;
+    }
+
+    fft2d_t* p_obj = (fft2d_t*) calloc(1, sizeof(fft2d_t));
+    if (p_obj == NULL) {
+        xil_printf("ERROR! Failed to allocate memory for 2D FFT object.\n\r");
+        return NULL;
+    }
+
+    p_obj->p_fft_inst    = p_fft_inst;
+    p_obj->num_rows      = num_rows;
+    p_obj->num_cols      = num_cols;
+    p_obj->fwd_inv       = FFT_FORWARD;
+    p_obj->row_scale_sch = fft_default_scale_sch(arch, num_cols);
+    p_obj->col_scale_sch = fft_default_scale_sch(arch, num_rows);
+
+    for (int i = 0; i < FFT2D_NUM_STRIPS; i++) {
+        p_obj->p_strips[i] = (complex_sample_t*) dma_accel_alloc_buf(sizeof(complex_sample_t)*FFT2D_STRIP_COLS*num_rows);
+        if (p_obj->p_strips[i] == NULL) {
+            xil_printf("ERROR! Failed to allocate memory for 2D FFT column strips.\n\r");
+            fft2d_destroy(p_obj);
+            return NULL;
+        }
+    }
+
+    return p_obj;
+
+}
+
+void fft2d_destroy(fft2d_t* p_fft2d_inst) {
+    for (int i = 0; i < FFT2D_NUM_STRIPS; i++) {
+        dma_accel_free_buf(p_fft2d_inst->p_strips[i]);
+    }
+    free(p_fft2d_inst);
+}
+
+void fft2d_set_fwd_inv(fft2d_t* p_fft2d_inst, fft_fwd_inv_t fwd_inv) {
+    p_fft2d_inst->fwd_inv = fwd_inv;
+}
+
+int fft2d_set_scale_sch(fft2d_t* p_fft2d_inst, int row_scale_sch, int col_scale_sch) {
+    int arch = fft_get_arch(p_fft2d_inst->p_fft_inst);
+
+    if ((fft_validate_scale_sch(arch, p_fft2d_inst->num_cols, row_scale_sch) != FFT_SUCCESS) ||
+        (fft_validate_scale_sch(arch, p_fft2d_inst->num_rows, col_scale_sch) != FFT_SUCCESS)) {
+        xil_printf("ERROR! Illegal scale schedule for a %d x %d FFT.\n\r", p_fft2d_inst->num_rows, p_fft2d_inst->num_cols);
+        return FFT2D_ILLEGAL_PARAMS;
+    }
+
+    p_fft2d_inst->row_scale_sch = row_scale_sch;
+    p_fft2d_inst->col_scale_sch = col_scale_sch;
+    return FFT2D_SUCCESS;
+}
+
+void fft2d_get_scale_sch(fft2d_t* p_fft2d_inst, int* p_row_scale_sch, int* p_col_scale_sch) {
+    *p_row_scale_sch = p_fft2d_inst->row_scale_sch;
+    *p_col_scale_sch = p_fft2d_inst->col_scale_sch;
+}
+
+int fft2d_get_scale_shift(fft2d_t* p_fft2d_inst) {
+    int arch = fft_get_arch(p_fft2d_inst->p_fft_inst);
+
+    return sched_shift(arch, p_fft2d_inst->num_cols, p_fft2d_inst->row_scale_sch) +
+           sched_shift(arch, p_fft2d_inst->num_rows, p_fft2d_inst->col_scale_sch);
+}
+
+int fft2d(fft2d_t* p_fft2d_inst, complex_sample_t* din, complex_sample_t* dout) {
+
+    int R          = p_fft2d_inst->num_rows;
+    int num_strips = p_fft2d_inst->num_cols / FFT2D_STRIP_COLS;
+
+    // row pass, rows are contiguous so they go to the engine as is
+    if (set_pass(p_fft2d_inst, p_fft2d_inst->num_cols, p_fft2d_inst->row_scale_sch) != FFT2D_SUCCESS) {
+        return FFT2D_FFT_FAIL;
+    }
+    if (fft_batch(p_fft2d_inst->p_fft_inst, din, dout, R) != FFT_SUCCESS) {
+        return FFT2D_FFT_FAIL;
+    }
+
+    // column pass. While frame f of strip s is in the engine, slice f of strip s+1
+    // is gathered and slice f of strip s-1 is scattered back
+    if (set_pass(p_fft2d_inst, R, p_fft2d_inst->col_scale_sch) != FFT2D_SUCCESS) {
+        return FFT2D_FFT_FAIL;
+    }
+
+    gather_strip(p_fft2d_inst, dout, 0, p_fft2d_inst->p_strips[0], 0, R);
+
+    for (int s = 0; s < num_strips; s++) {
+        complex_sample_t* p_cur  = p_fft2d_inst->p_strips[s % FFT2D_NUM_STRIPS];
+        complex_sample_t* p_next = p_fft2d_inst->p_strips[(s + 1) % FFT2D_NUM_STRIPS];
+        complex_sample_t* p_prev = p_fft2d_inst->p_strips[(s + FFT2D_NUM_STRIPS - 1) % FFT2D_NUM_STRIPS];
+
+        for (int f = 0; f < FFT2D_STRIP_COLS; f++) {
+            fft_set_queue_depth(p_fft2d_inst->p_fft_inst, (num_strips - s)*FFT2D_STRIP_COLS - f - 1);
+            if (fft_start(p_fft2d_inst->p_fft_inst, &p_cur[f*R], &p_cur[f*R]) != FFT_SUCCESS) {
+                return FFT2D_FFT_FAIL;
+            }
+
+            int row_lo = slice_row(p_fft2d_inst, f);
+            int row_hi = (f == FFT2D_STRIP_COLS - 1) ? R : slice_row(p_fft2d_inst, f + 1);
+
+            if (s + 1 < num_strips) {
+                gather_strip(p_fft2d_inst, dout, (s + 1)*FFT2D_STRIP_COLS, p_next, row_lo, row_hi);
+            }
+            if (s > 0) {
+                scatter_strip(p_fft2d_inst, dout, (s - 1)*FFT2D_STRIP_COLS, p_prev, row_lo, row_hi);
+            }
+
+            if (fft_wait(p_fft2d_inst->p_fft_inst) != FFT_SUCCESS) {
+                return FFT2D_FFT_FAIL;
+            }
+        }
+    }
+
+    scatter_strip(p_fft2d_inst, dout, (num_strips - 1)*FFT2D_STRIP_COLS, p_fft2d_inst->p_strips[(num_strips - 1) % FFT2D_NUM_STRIPS], 0, R);
+
+    return FFT2D_SUCCESS;
+}
@@ -0,0 +1,42 @@
+#ifndef FFT2D_H
+#define FFT2D_H
+
+#include "complex_sample.h"
+#include "fft.h"
+
+#define FFT2D_SUCCESS          0
+#define FFT2D_ILLEGAL_PARAMS  -1
+#define FFT2D_ALLOC_FAIL      -2
+#define FFT2D_FFT_FAIL        -3
+
+// columns are transformed this many at a time. 8 samples are one cache line,
+// so gathering a strip reads exactly one line per row
+#define FFT2D_STRIP_COLS       8
+
+typedef struct fft2d fft2d_t;
+
+// num_rows x num_cols transform on the 1D engine. Both dimensions must be powers
+// of 2 the engine supports, num_cols at least FFT2D_STRIP_COLS. The column strips
+// take FFT2D_STRIP_COLS*num_rows samples each from the heap, 768 KB in all at
+// 8192 rows
+fft2d_t* fft2d_create(fft_t* p_fft_inst, int num_rows, int num_cols);
+
+void fft2d_destroy(fft2d_t* p_fft2d_inst);
+
+void fft2d_set_fwd_inv(fft2d_t* p_fft2d_inst, fft_fwd_inv_t fwd_inv);
+
+// schedules for the row pass (num_cols-point transforms) and the column pass
+// (num_rows-point transforms). Both default to the engine's conservative schedule
+int fft2d_set_scale_sch(fft2d_t* p_fft2d_inst, int row_scale_sch, int col_scale_sch);
+
+void fft2d_get_scale_sch(fft2d_t* p_fft2d_inst, int* p_row_scale_sch, int* p_col_scale_sch);
+
+// total right shift of both passes
+int fft2d_get_scale_shift(fft2d_t* p_fft2d_inst);
+
+// din and dout are row-major num_rows x num_cols and may be the same buffer.
+// Rows go straight through the engine. Columns are streamed through in strips of
+// FFT2D_STRIP_COLS, so no transposed copy of the whole matrix is ever made
+int fft2d(fft2d_t* p_fft2d_inst, complex_sample_t* din, complex_sample_t* dout);
+
+#endif // FFT2D_H
@@ -0,0 +1,315 @@
+#include <stdlib.h>
+#include <math.h>
+#include "xtime_l.h"
+#include "fft_autotune.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// engine parameters saved while candidates are measured
+typedef struct engine_params {
+    int           arch;
+    int           num_pts;
+    fft_fwd_inv_t fwd_inv;
+    int           scale_sch;
+} engine_params_t;
+
+static void save_params(fft_t* p_fft_inst, engine_params_t* p_params) {
+    p_params->arch      = fft_get_arch(p_fft_inst);
+    p_params->num_pts   = fft_get_num_pts(p_fft_inst);
+    p_params->fwd_inv   = fft_get_fwd_inv(p_fft_inst);
+    p_params->scale_sch = fft_get_scale_sch(p_fft_inst);
+}
+
+static void restore_params(fft_t* p_fft_inst, const engine_params_t* p_params) {
+    fft_set_num_pts(p_fft_inst, p_params->num_pts);
+    fft_set_fwd_inv(p_fft_inst, p_params->fwd_inv);
+    fft_set_scale_sch(p_fft_inst, p_params->scale_sch);
+}
+
+// largest scale a stage of this architecture accepts
+static int stage_max(int arch, int num_pts, int stage) {
+    int num_stages = fft_scale_sch_num_stages(arch, num_pts);
+    int log2_N     = fft_scale_sch_num_stages(FFT_ARCH_RADIX2, num_pts); // one radix-2 stage per bit
+
+    if ((arch == FFT_ARCH_PIPELINED || arch == FFT_ARCH_RADIX4) && (log2_N % 2 == 1) && (stage == num_stages - 1)) {
+        return 1;
+    }
+    return 3;
+}
+
+// spread a total shift over the stages, either filling early stages first
+// (guards against overflow) or late stages first (keeps more precision early on).
+// Returns -1 if the total can't be reached
+static int build_schedule(int arch, int num_pts, int total, int front_loaded) {
+    int num_stages = fft_scale_sch_num_stages(arch, num_pts);
+    int scale_sch  = 0;
+
+    for (int i = 0; (i < num_stages) && (total > 0); i++) {
+        int stage = front_loaded ? i : (num_stages - 1 - i);
+        int scale = stage_max(arch, num_pts, stage);
+        if (scale > total) {
+            scale = total;
+        }
+        scale_sch |= scale << (2*stage);
+        total     -= scale;
+    }
+
+    return (total == 0) ? scale_sch : -1;
+}
+
+// candidate schedules around the bit growth of a log2(N)-stage transform
+static int build_candidates(int arch, int num_pts, int* p_candidates) {
+    int num    = 0;
+    int log2_N = fft_scale_sch_num_stages(FFT_ARCH_RADIX2, num_pts);
+
+    p_candidates[num++] = fft_default_scale_sch(arch, num_pts);
+
+    for (int total = log2_N - 2; total <= log2_N + 1; total++) {
+        for (int front_loaded = 0; front_loaded <= 1; front_loaded++) {
+            int scale_sch = build_schedule(arch, num_pts, (total < 0 ? 0 : total), front_loaded);
+            int dup       = 0;
+
+            if ((scale_sch < 0) || (fft_validate_scale_sch(arch, num_pts, scale_sch) != FFT_SUCCESS)) {
+                continue;
+            }
+            for (int i = 0; i < num; i++) {
+                dup |= (p_candidates[i] == scale_sch);
+            }
+            if (!dup && (num < FFT_AUTOTUNE_MAX_CANDIDATES)) {
+                p_candidates[num++] = scale_sch;
+            }
+        }
+    }
+
+    return num;
+}
+
+// in-place double precision radix-2 reference transform, natural order in and out
+static void reference_fft(double* re, double* im, int num_pts, fft_fwd_inv_t fwd_inv) {
+
+    // bit reversal permutation
+    for (int i = 1, j = 0; i < num_pts; i++) {
+        int bit = num_pts >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            double t;
+            t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    double sign = (fwd_inv == FFT_FORWARD) ? -1.0 : 1.0;
+    for (int len = 2; len <= num_pts; len <<= 1) {
+        double ang = sign*2.0*M_PI/len;
+        for (int i = 0; i < num_pts; i += len) {
+            for (int k = 0; k < len/2; k++) {
+                double wr = cos(ang*k);
+                double wi = sin(ang*k);
+                int    a  = i + k;
+                int    b  = i + k + len/2;
+                double xr = re[b]*wr - im[b]*wi;
+                double xi = re[b]*wi + im[b]*wr;
+                re[b] = re[a] - xr;
+                im[b] = im[a] - xi;
+                re[a] += xr;
+                im[a] += xi;
+            }
+        }
+    }
+
+}
+
+// snr of the engine output against the reference scaled by 2^-shift, in tenths of a dB
+static int measure_snr_x10(const complex_sample_t* dout, const double* ref_re, const double* ref_im, int num_pts, int shift) {
+    double scale = ldexp(1.0, -shift);
+    double sig   = 0.0;
+    double err   = 0.0;
+
+    for (int i = 0; i < num_pts; i++) {
+        double r  = ref_re[i]*scale;
+        double q  = ref_im[i]*scale;
+        double dr = dout[i].data_re - r;
+        double dq = dout[i].data_im - q;
+        sig += r*r + q*q;
+        err += dr*dr + dq*dq;
+    }
+
+    if (err == 0.0) {
+        return 9999;
+    }
+    return (int)(100.0*log10(sig/err));
+}
+
+// is a better than b for the objective
+static int is_better(const fft_autotune_result_t* a, const fft_autotune_result_t* b, const fft_autotune_workload_t* p_workload) {
+    int a_ok = (a->snr_db_x10 >= p_workload->min_snr_db*10);
+    int b_ok = (b->snr_db_x10 >= p_workload->min_snr_db*10);
+
+    if (a_ok != b_ok) {
+        return a_ok;
+    }
+    if (!a_ok) {
+        return (a->snr_db_x10 > b->snr_db_x10);
+    }
+
+    if (p_workload->objective == FFT_AUTOTUNE_LATENCY && a->latency_ticks != b->latency_ticks) {
+        return (a->latency_ticks < b->latency_ticks);
+    }
+    if (p_workload->objective == FFT_AUTOTUNE_THROUGHPUT && a->frames_per_sec != b->frames_per_sec) {
+        return (a->frames_per_sec > b->frames_per_sec);
+    }
+
+    return (a->snr_db_x10 > b->snr_db_x10);
+}
+
+// run one candidate and fill in its measurements
+static int measure(fft_t* p_fft_inst, const fft_autotune_workload_t* p_workload, complex_sample_t* din, complex_sample_t* dout,
+                   const double* ref_re, const double* ref_im, fft_autotune_result_t* p_result) {
+
+    int                num_iters   = (p_workload->num_iters > 0) ? p_workload->num_iters : 1;
+    unsigned long long min_ticks   = ~0ULL;
+    XTime              t0, t1;
+
+    // latency: single frames with nothing queued behind them
+    fft_set_queue_depth(p_fft_inst, 0);
+    for (int i = 0; i < num_iters; i++) {
+        XTime_GetTime(&t0);
+        int status = fft(p_fft_inst, din, dout);
+        XTime_GetTime(&t1);
+
+        if (status != FFT_SUCCESS) {
+            return FFT_AUTOTUNE_FFT_FAIL;
+        }
+
+        if ((t1 - t0) < min_ticks) {
+            min_ticks = t1 - t0;
+        }
+    }
+
+    // throughput: the same frames back to back with the queue depth reported,
+    // so the dma picks the completion mode it would use for a stream
+    XTime_GetTime(&t0);
+    for (int i = 0; i < num_iters; i++) {
+        fft_set_queue_depth(p_fft_inst, num_iters - i - 1);
+        if ((fft_start(p_fft_inst, din, dout) != FFT_SUCCESS) || (fft_wait(p_fft_inst) != FFT_SUCCESS)) {
+            return FFT_AUTOTUNE_FFT_FAIL;
+        }
+    }
+    XTime_GetTime(&t1);
+
+    unsigned long long total_ticks = t1 - t0;
+
+    p_result->scale_sch      = fft_get_scale_sch(p_fft_inst);
+    p_result->latency_ticks  = min_ticks;
+    p_result->frames_per_sec = (total_ticks == 0) ? 0 : (unsigned int)(((unsigned long long)num_iters*COUNTS_PER_SECOND)/total_ticks);
+    p_result->snr_db_x10     = measure_snr_x10(dout, ref_re, ref_im, p_workload->num_pts, fft_get_scale_shift(p_fft_inst));
+
+    return FFT_AUTOTUNE_SUCCESS;
+
+}
+
+// Public functions
+int fft_autotune(fft_t** p_engines, int num_engines, const fft_autotune_workload_t* p_workload,
+                 fft_autotune_result_t* p_best) {
+
+    const int          num_pts = p_workload->num_pts;
+    complex_sample_t*  din     = (complex_sample_t*) malloc(sizeof(complex_sample_t)*num_pts);
+    complex_sample_t*  dout    = (complex_sample_t*) malloc(sizeof(complex_sample_t)*num_pts);
+    double*            ref_re  = (double*) malloc(sizeof(double)*num_pts);
+    double*            ref_im  = (double*) malloc(sizeof(double)*num_pts);
+    int                status  = FFT_AUTOTUNE_NO_CONFIG;
+    int                found   = 0;
+
+    if (din == NULL || dout == NULL || ref_re == NULL || ref_im == NULL) {
+        xil_printf("ERROR! Failed to allocate memory for the FFT autotuner.\n\r");
+        free(din);
+        free(dout);
+        free(ref_re);
+        free(ref_im);
+        return FFT_AUTOTUNE_ALLOC_FAIL;
+    }
+
+    // stimulus and its reference spectrum
+    unsigned int lcg = 12345;
+    for (int i = 0; i < num_pts; i++) {
+        if (p_workload->p_stimulus != NULL) {
+            din[i] = p_workload->p_stimulus[i];
+        } else {
+            lcg = lcg*1103515245 + 12345;
+            din[i].data_re = (short)(lcg >> 16);
+            lcg = lcg*1103515245 + 12345;
+            din[i].data_im = (short)(lcg >> 16);
+        }
+        ref_re[i] = din[i].data_re;
+        ref_im[i] = din[i].data_im;
+    }
+    reference_fft(ref_re, ref_im, num_pts, p_workload->fwd_inv);
+
+    for (int e = 0; e < num_engines; e++) {
+        fft_t*          p_fft_inst = p_engines[e];
+        engine_params_t saved;
+        int             candidates[FFT_AUTOTUNE_MAX_CANDIDATES];
+
+        save_params(p_fft_inst, &saved);
+
+        // skip engines whose core can't run this size
+        if (fft_set_num_pts(p_fft_inst, num_pts) != FFT_SUCCESS) {
+            restore_params(p_fft_inst, &saved);
+            continue;
+        }
+        fft_set_fwd_inv(p_fft_inst, p_workload->fwd_inv);
+
+        int num_candidates = build_candidates(saved.arch, num_pts, candidates);
+        for (int c = 0; c < num_candidates; c++) {
+            fft_autotune_result_t result;
+
+            fft_set_scale_sch(p_fft_inst, candidates[c]);
+            result.engine = e;
+            result.arch   = saved.arch;
+
+            if (measure(p_fft_inst, p_workload, din, dout, ref_re, ref_im, &result) != FFT_AUTOTUNE_SUCCESS) {
+                xil_printf("ERROR! FFT failed while autotuning engine %d.\n\r", e);
+                continue;
+            }
+
+            if (!found || is_better(&result, p_best, p_workload)) {
+                *p_best = result;
+                found   = 1;
+            }
+        }
+
+        restore_params(p_fft_inst, &saved);
+    }
+
+    // leave the winning engine configured for the workload
+    if (found) {
+        fft_t* p_fft_inst = p_engines[p_best->engine];
+        fft_set_num_pts(p_fft_inst, num_pts);
+        fft_set_fwd_inv(p_fft_inst, p_workload->fwd_inv);
+        fft_set_scale_sch(p_fft_inst, p_best->scale_sch);
+
+        status = (p_best->snr_db_x10 >= p_workload->min_snr_db*10) ? FFT_AUTOTUNE_SUCCESS : FFT_AUTOTUNE_SNR_NOT_MET;
+    }
+
+    free(din);
+    free(dout);
+    free(ref_re);
+    free(ref_im);
+
+    return status;
+
+}
+
+void fft_autotune_print_result(const fft_autotune_result_t* p_result) {
+    xil_printf("engine         = %d\n\r", p_result->engine);
+    xil_printf("arch           = %d\n\r", p_result->arch);
+    xil_printf("scale_sch      = 0x%X\n\r", p_result->scale_sch);
+    xil_printf("snr            = %d.%d dB\n\r", p_result->snr_db_x10/10, abs(p_result->snr_db_x10%10));
+    xil_printf("latency        = %d ticks\n\r", (int)p_result->latency_ticks);
+    xil_printf("frames per sec = %d\n\r", p_result->frames_per_sec);
+}
@@ -0,0 +1,50 @@
+#ifndef FFT_AUTOTUNE_H
+#define FFT_AUTOTUNE_H
+
+#include "fft.h"
+
+#define FFT_AUTOTUNE_SUCCESS          0
+#define FFT_AUTOTUNE_ALLOC_FAIL      -1
+#define FFT_AUTOTUNE_NO_CONFIG       -2 // no engine supports the workload size
+#define FFT_AUTOTUNE_SNR_NOT_MET     -3 // best effort result returned, below min_snr_db
+#define FFT_AUTOTUNE_FFT_FAIL        -4
+
+// max number of scale schedules tried per engine
+#define FFT_AUTOTUNE_MAX_CANDIDATES  16
+
+typedef enum
+{
+    FFT_AUTOTUNE_LATENCY    = 0, // minimize time for a single frame
+    FFT_AUTOTUNE_THROUGHPUT = 1  // maximize frames per second over back-to-back frames
+} fft_autotune_objective_t;
+
+// what the engine will be used for
+typedef struct fft_autotune_workload
+{
+    int                      num_pts;
+    fft_fwd_inv_t            fwd_inv;
+    fft_autotune_objective_t objective;
+    int                      min_snr_db;   // candidates below this are only used if nothing is better
+    int                      num_iters;    // frames timed per candidate
+    const complex_sample_t*  p_stimulus;   // num_pts representative samples, or NULL for full scale noise
+} fft_autotune_workload_t;
+
+typedef struct fft_autotune_result
+{
+    int                engine;          // index into the engine array
+    int                arch;
+    int                scale_sch;
+    int                snr_db_x10;      // snr in tenths of a dB against a double precision reference
+    unsigned long long latency_ticks;   // global timer ticks for one frame
+    unsigned int       frames_per_sec;
+} fft_autotune_result_t;
+
+// measure every engine (one per available core configuration) over a set of
+// scale schedules for the workload, then set the winning schedule on the
+// winning engine. The other engines get their previous parameters back.
+int fft_autotune(fft_t** p_engines, int num_engines, const fft_autotune_workload_t* p_workload,
+                 fft_autotune_result_t* p_best);
+
+void fft_autotune_print_result(const fft_autotune_result_t* p_result);
+
+#endif // FFT_AUTOTUNE_H
@@ -0,0 +1,299 @@
+#ifndef FFT_ENGINE_HPP
+#define FFT_ENGINE_HPP
+
+// C++20 front-end over the fft/dma_accel C API. Header only.
+//
+//   accel::FftEngine engine(XPAR_GPIO_0_DEVICE_ID, ...);
+//   accel::Frame<1024> frame;
+//
+//   accel::Task work(accel::FftEngine& engine, accel::Frame<1024>& frame) {
+//       int status = co_await engine.transform(frame);
+//       ...
+//   }
+//
+//   auto a = work(engine, frame_a);
+//   auto b = work(engine, frame_b);
+//   engine.run_until_idle();
+//
+// Transforms are queued on the engine and started back to back. The dma
+// completion interrupt posts to the completion ring, and poll() retires the
+// finished transform and resumes the coroutine waiting on it from the main loop,
+// never from the isr.
+
+#include <coroutine>
+#include <exception>
+#include <span>
+#include <utility>
+
+extern "C" {
+#include "fft.h"
+}
+
+namespace accel {
+
+static_assert(sizeof(complex_sample_t) == 2*sizeof(short), "complex_sample_t must match the core's 16+16 bit stream");
+
+// owning, move-only frame of N samples in dma-safe memory
+template <int N>
+class Frame
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "FFT size must be a power of 2");
+    static_assert(N >= FFT_MIN_NUM_PTS, "FFT size is below FFT_MIN_NUM_PTS");
+    static_assert(N <= FFT_MAX_NUM_PTS, "FFT size exceeds FFT_MAX_NUM_PTS");
+
+public:
+    static constexpr int num_pts = N;
+
+    Frame() : p_buf_(static_cast<complex_sample_t*>(dma_accel_alloc_buf(N*sizeof(complex_sample_t)))) {}
+
+    ~Frame() { dma_accel_free_buf(p_buf_); }
+
+    Frame(const Frame&)            = delete;
+    Frame& operator=(const Frame&) = delete;
+
+    Frame(Frame&& other) noexcept : p_buf_(std::exchange(other.p_buf_, nullptr)) {}
+
+    Frame& operator=(Frame&& other) noexcept {
+        if (this != &other) {
+            dma_accel_free_buf(p_buf_);
+            p_buf_ = std::exchange(other.p_buf_, nullptr);
+        }
+        return *this;
+    }
+
+    // false if the allocation failed or the frame was moved from
+    explicit operator bool() const { return p_buf_ != nullptr; }
+
+    complex_sample_t*       data()       { return p_buf_; }
+    const complex_sample_t* data() const { return p_buf_; }
+
+    std::span<complex_sample_t, N>       span()       { return std::span<complex_sample_t, N>(p_buf_, N); }
+    std::span<const complex_sample_t, N> span() const { return std::span<const complex_sample_t, N>(p_buf_, N); }
+
+    complex_sample_t&       operator[](int i)       { return p_buf_[i]; }
+    const complex_sample_t& operator[](int i) const { return p_buf_[i]; }
+
+private:
+    complex_sample_t* p_buf_;
+};
+
+// fire and forget coroutine. Starts running when called, the handle is kept so
+// the frame is released when the Task goes away. Keep it alive until done(),
+// a Task destroyed while waiting on the engine leaves a dangling queue entry
+class Task
+{
+public:
+    struct promise_type
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_never  initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+    Task& operator=(Task&&)      = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool done() const { return !handle_ || handle_.done(); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+class FftEngine;
+
+// one queued transform. Lives in the awaiting coroutine's frame while suspended,
+// so the engine links them together without allocating
+class TransformAwaiter
+{
+public:
+    // a frame without a buffer completes at once with FFT_ALLOC_FAIL
+    bool await_ready() const noexcept { return status_ != FFT_SUCCESS; }
+    inline void await_suspend(std::coroutine_handle<> handle);
+    int  await_resume() const noexcept { return status_; }
+
+private:
+    friend class FftEngine;
+
+    TransformAwaiter(FftEngine* p_engine, complex_sample_t* din, complex_sample_t* dout, int num_pts, fft_fwd_inv_t fwd_inv)
+        : p_engine_(p_engine), din_(din), dout_(dout), num_pts_(num_pts), fwd_inv_(fwd_inv),
+          status_(((din != nullptr) && (dout != nullptr)) ? FFT_SUCCESS : FFT_ALLOC_FAIL) {}
+
+    FftEngine*              p_engine_;
+    complex_sample_t*       din_;
+    complex_sample_t*       dout_;
+    int                     num_pts_;
+    fft_fwd_inv_t           fwd_inv_;
+    int                     status_;
+    std::coroutine_handle<> handle_;
+    TransformAwaiter*       p_next_ = nullptr;
+};
+
+// owning wrapper of one fft_t
+class FftEngine
+{
+public:
+    FftEngine(int gpio_device_id, int dma_device_id, int intc_device_id, int s2mm_intr_id, int mm2s_intr_id)
+        : p_fft_inst_(fft_create(gpio_device_id, dma_device_id, intc_device_id, s2mm_intr_id, mm2s_intr_id)) {}
+
+    ~FftEngine() {
+        // a transform still in the engine would write into a frame that may be gone
+        if (p_running_ != nullptr) {
+            fft_wait(p_fft_inst_);
+        }
+        if (p_fft_inst_ != nullptr) {
+            fft_destroy(p_fft_inst_);
+        }
+    }
+
+    // awaiters point back at the engine, so it stays put
+    FftEngine(const FftEngine&)            = delete;
+    FftEngine& operator=(const FftEngine&) = delete;
+
+    // false if fft_create failed
+    explicit operator bool() const { return p_fft_inst_ != nullptr; }
+
+    fft_t* get() { return p_fft_inst_; }
+
+    // blocking transform, for code that isn't a coroutine
+    template <int N>
+    int transform_now(Frame<N>& din, Frame<N>& dout, fft_fwd_inv_t fwd_inv = FFT_FORWARD) {
+        if (!din || !dout) {
+            return FFT_ALLOC_FAIL;
+        }
+        int status = configure(N, fwd_inv);
+        if (status != FFT_SUCCESS) {
+            return status;
+        }
+        return ::fft(p_fft_inst_, din.data(), dout.data());
+    }
+
+    template <int N>
+    TransformAwaiter transform(Frame<N>& frame, fft_fwd_inv_t fwd_inv = FFT_FORWARD) {
+        return TransformAwaiter(this, frame.data(), frame.data(), N, fwd_inv);
+    }
+
+    template <int N>
+    TransformAwaiter transform(Frame<N>& din, Frame<N>& dout, fft_fwd_inv_t fwd_inv = FFT_FORWARD) {
+        return TransformAwaiter(this, din.data(), dout.data(), N, fwd_inv);
+    }
+
+    // retire the running transform if it's done, start the next queued one and
+    // resume whoever was waiting. Call from the main loop
+    void poll() {
+        if (p_running_ != nullptr) {
+            int status = fft_poll(p_fft_inst_);
+            if (status == FFT_BUSY) {
+                return;
+            }
+
+            TransformAwaiter* p_done = std::exchange(p_running_, nullptr);
+            p_done->status_ = status;
+            push(p_ready_head_, p_ready_tail_, p_done);
+        }
+
+        // start the next frame before resuming so the dma overlaps the coroutine
+        start_next();
+
+        while (TransformAwaiter* p_ready = pop(p_ready_head_, p_ready_tail_)) {
+            p_ready->handle_.resume();
+        }
+    }
+
+    bool idle() const { return (p_running_ == nullptr) && (p_queue_head_ == nullptr) && (p_ready_head_ == nullptr); }
+
+    void run_until_idle() {
+        while (!idle()) {
+            poll();
+        }
+    }
+
+private:
+    friend class TransformAwaiter;
+
+    static void push(TransformAwaiter*& p_head, TransformAwaiter*& p_tail, TransformAwaiter* p_awaiter) {
+        p_awaiter->p_next_ = nullptr;
+        if (p_tail != nullptr) {
+            p_tail->p_next_ = p_awaiter;
+        } else {
+            p_head = p_awaiter;
+        }
+        p_tail = p_awaiter;
+    }
+
+    static TransformAwaiter* pop(TransformAwaiter*& p_head, TransformAwaiter*& p_tail) {
+        TransformAwaiter* p_awaiter = p_head;
+        if (p_awaiter != nullptr) {
+            p_head = p_awaiter->p_next_;
+            if (p_head == nullptr) {
+                p_tail = nullptr;
+            }
+        }
+        return p_awaiter;
+    }
+
+    // a size the core can't run leaves the engine at its old length, which
+    // must not be started into a smaller frame
+    int configure(int num_pts, fft_fwd_inv_t fwd_inv) {
+        return fft_ensure_config(p_fft_inst_, num_pts, fwd_inv);
+    }
+
+    void enqueue(TransformAwaiter* p_awaiter) {
+        push(p_queue_head_, p_queue_tail_, p_awaiter);
+        num_queued_++;
+        if (p_running_ == nullptr) {
+            start_next();
+        }
+    }
+
+    // frames that fail to start are handed back through the ready list
+    void start_next() {
+        while (p_running_ == nullptr) {
+            TransformAwaiter* p_next = pop(p_queue_head_, p_queue_tail_);
+            if (p_next == nullptr) {
+                return;
+            }
+            num_queued_--;
+
+            int status = configure(p_next->num_pts_, p_next->fwd_inv_);
+            if (status == FFT_SUCCESS) {
+                fft_set_queue_depth(p_fft_inst_, num_queued_);
+                status = fft_start(p_fft_inst_, p_next->din_, p_next->dout_);
+            }
+            if (status == FFT_SUCCESS) {
+                p_running_ = p_next;
+            } else {
+                p_next->status_ = status;
+                push(p_ready_head_, p_ready_tail_, p_next);
+            }
+        }
+    }
+
+    fft_t*            p_fft_inst_;
+    TransformAwaiter* p_running_    = nullptr;
+    TransformAwaiter* p_queue_head_ = nullptr;
+    TransformAwaiter* p_queue_tail_ = nullptr;
+    int               num_queued_   = 0;       // awaiters behind the running one
+    TransformAwaiter* p_ready_head_ = nullptr;
+    TransformAwaiter* p_ready_tail_ = nullptr;
+};
+
+inline void TransformAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    p_engine_->enqueue(this);
+}
+
+} // namespace accel
+
+#endif // FFT_ENGINE_HPP
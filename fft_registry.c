@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include "xil_printf.h"
+#include "xil_exception.h"
+#include "xscugic.h"
+#include "xtime_l.h"
+#include "fft_registry.h"
+
+typedef struct fft_registry {
+    XScuGic            intc_inst;   // shared by every engine
+    int                num_engines;
+    fft_t*             engines[FFT_REGISTRY_MAX_ENGINES];
+    unsigned long long create_time;
+    unsigned long long ready_time;   // first time fft_registry_wait_ready saw every engine ready, 0 before
+} fft_registry_t;
+
+static int init_intc(XScuGic* p_intc_inst, int intc_device_id) {
+
+    // lookup hardware configuration
+    XScuGic_Config* cfg_ptr = XScuGic_LookupConfig(intc_device_id);
+    if (!cfg_ptr) {
+        xil_printf("ERROR! No hardware configuration found for Interrupt Controller with device id %d.\r\n", intc_device_id);
+        return FFT_REGISTRY_ILLEGAL_PARAMS;
+    }
+
+    // init driver
+    int status = XScuGic_CfgInitialize(p_intc_inst, cfg_ptr, cfg_ptr->CpuBaseAddress);
+    if (status != XST_SUCCESS)
+    {
+        xil_printf("ERROR! Initialization of Interrupt Controller failed with %d.\r\n", status);
+        return FFT_REGISTRY_ILLEGAL_PARAMS;
+    }
+
+    // initialize exception table and register handler, once for all engines
+    Xil_ExceptionInit();
+    Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT, (Xil_ExceptionHandler)XScuGic_InterruptHandler, p_intc_inst);
+
+    // enable noncritical exceptions
+    Xil_ExceptionEnable();
+
+    return FFT_REGISTRY_SUCCESS;
+
+}
+
+static unsigned long long ticks_to_us(unsigned long long ticks) {
+    return (ticks*1000000)/COUNTS_PER_SECOND;
+}
+
+// Public functions
+fft_registry_t* fft_registry_create(int intc_device_id, const fft_engine_desc_t* p_descs, int num_engines) {
+
+    XTime start;
+    XTime_GetTime(&start);
+
+    if ((p_descs == NULL) || (num_engines < 1) || (num_engines > FFT_REGISTRY_MAX_ENGINES)) {
+        xil_printf("ERROR! Illegal FFT registry parameters.\n\r");
+        return NULL;
+    }
+
+    fft_registry_t* p_obj = (fft_registry_t*) calloc(1, sizeof(fft_registry_t));
+    if (p_obj == NULL) {
+        xil_printf("ERROR! Failed to allocate memory for FFT registry object.\n\r");
+        return NULL;
+    }
+    p_obj->create_time = start;
+
+    if (init_intc(&p_obj->intc_inst, intc_device_id) != FFT_REGISTRY_SUCCESS) {
+        xil_printf("ERROR! Failed to initialize Interrupt controller.\n\r");
+        free(p_obj);
+        return NULL;
+    }
+
+    // every reset is started here and left running
+    for (int i = 0; i < num_engines; i++) {
+        const fft_engine_desc_t* p_desc = &p_descs[i];
+
+        p_obj->engines[i] = fft_create_ex(p_desc->gpio_device_id, p_desc->dma_device_id, &p_obj->intc_inst,
+                                          p_desc->s2mm_intr_id, p_desc->mm2s_intr_id, p_desc->num_pts);
+        if (p_obj->engines[i] == NULL) {
+            xil_printf("ERROR! Failed to create FFT engine %d.\n\r", i);
+            fft_registry_destroy(p_obj);
+            return NULL;
+        }
+        p_obj->num_engines++;
+    }
+
+    return p_obj;
+
+}
+
+void fft_registry_destroy(fft_registry_t* p_reg_inst) {
+    // each engine disables and disconnects its own lines on the way out
+    for (int i = 0; i < p_reg_inst->num_engines; i++) {
+        fft_destroy(p_reg_inst->engines[i]);
+    }
+
+    // the exception table still points at the controller about to be freed
+    Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT, (Xil_ExceptionHandler)Xil_ExceptionNullHandler, NULL);
+    free(p_reg_inst);
+}
+
+int fft_registry_get_num_engines(fft_registry_t* p_reg_inst) {
+    return (p_reg_inst->num_engines);
+}
+
+fft_t* fft_registry_get(fft_registry_t* p_reg_inst, int index) {
+    if ((index < 0) || (index >= p_reg_inst->num_engines)) {
+        xil_printf("ERROR! No FFT engine %d.\n\r", index);
+        return NULL;
+    }
+    return p_reg_inst->engines[index];
+}
+
+int fft_registry_wait_ready(fft_registry_t* p_reg_inst, int timeout_us) {
+
+    XTime start, now;
+    int   num_busy;
+
+    XTime_GetTime(&start);
+    do {
+        num_busy = 0;
+        for (int i = 0; i < p_reg_inst->num_engines; i++) {
+            int status = fft_poll_ready(p_reg_inst->engines[i]);
+            if (status == FFT_BUSY) {
+                num_busy++;
+            } else if (status != FFT_SUCCESS) {
+                xil_printf("ERROR! FFT engine %d failed to come out of reset.\n\r", i);
+                return FFT_REGISTRY_INIT_FAIL;
+            }
+        }
+        XTime_GetTime(&now);
+    } while ((num_busy > 0) && ((now - start) < ((XTime)timeout_us*COUNTS_PER_SECOND)/1000000));
+
+    if (num_busy > 0) {
+        for (int i = 0; i < p_reg_inst->num_engines; i++) {
+            if (fft_poll_ready(p_reg_inst->engines[i]) == FFT_BUSY) {
+                xil_printf("ERROR! FFT engine %d did not come out of reset within %d us.\n\r", i, timeout_us);
+            }
+        }
+        return FFT_REGISTRY_TIMEOUT;
+    }
+
+    if (p_reg_inst->ready_time == 0) {
+        p_reg_inst->ready_time = now;
+    }
+
+    return FFT_REGISTRY_SUCCESS;
+
+}
+
+unsigned long long fft_registry_get_time_to_ready(fft_registry_t* p_reg_inst) {
+    return (p_reg_inst->ready_time == 0) ? 0 : p_reg_inst->ready_time - p_reg_inst->create_time;
+}
+
+unsigned long long fft_registry_get_time_to_first_fft(fft_registry_t* p_reg_inst) {
+
+    unsigned long long first = 0;
+
+    for (int i = 0; i < p_reg_inst->num_engines; i++) {
+        unsigned long long done = fft_get_first_done_time(p_reg_inst->engines[i]);
+        if ((done != 0) && ((first == 0) || (done < first))) {
+            first = done;
+        }
+    }
+
+    return (first == 0) ? 0 : first - p_reg_inst->create_time;
+
+}
+
+void fft_registry_print_startup(fft_registry_t* p_reg_inst) {
+
+    unsigned long long ready = fft_registry_get_time_to_ready(p_reg_inst);
+    unsigned long long first = fft_registry_get_time_to_first_fft(p_reg_inst);
+
+    if (ready == 0) {
+        xil_printf("time to ready     = (not waited for)\n\r");
+    } else {
+        xil_printf("time to ready     = %d us\n\r", (int)ticks_to_us(ready));
+    }
+
+    // includes however long the application took to ask for a transform
+    if (first == 0) {
+        xil_printf("time to first FFT = (no FFT yet)\n\r");
+        return;
+    }
+    xil_printf("time to first FFT = %d us\n\r", (int)ticks_to_us(first));
+
+    for (int i = 0; i < p_reg_inst->num_engines; i++) {
+        unsigned long long done = fft_get_first_done_time(p_reg_inst->engines[i]);
+        if (done == 0) {
+            xil_printf("  engine %d: not used yet\n\r", i);
+        } else {
+            xil_printf("  engine %d: first FFT after %d us\n\r", i, (int)ticks_to_us(done - p_reg_inst->create_time));
+        }
+    }
+
+}
@@ -0,0 +1,68 @@
+#ifndef FFT_REGISTRY_H
+#define FFT_REGISTRY_H
+
+#include "xscugic.h"
+#include "fft.h"
+
+#define FFT_REGISTRY_SUCCESS         0
+#define FFT_REGISTRY_ILLEGAL_PARAMS -1
+#define FFT_REGISTRY_TIMEOUT        -2
+#define FFT_REGISTRY_INIT_FAIL      -3
+
+#define FFT_REGISTRY_MAX_ENGINES     8
+
+// one engine, as wired up in the hardware design
+typedef struct fft_engine_desc
+{
+    int gpio_device_id;
+    int dma_device_id;
+    int s2mm_intr_id;
+    int mm2s_intr_id;
+    int num_pts;        // initial size
+} fft_engine_desc_t;
+
+typedef struct fft_registry fft_registry_t;
+
+// for several engines on one interrupt controller. p_intc_inst must already be
+// initialized and wired to the exception table, this only connects the isrs.
+// The dma reset is started but not waited for: the engine becomes ready on its
+// first submit, or earlier through dma_accel_poll_ready/dma_accel_wait_ready
+dma_accel_t* dma_accel_create_ex(int dma_device_id, XScuGic* p_intc_inst, int s2mm_intr_id,
+                                 int mm2s_intr_id, int sample_size_bytes);
+
+// engine on a shared, already initialized interrupt controller. Doesn't wait
+// for the dma to come out of reset, that happens on first use or through
+// fft_poll_ready/fft_wait_ready
+fft_t* fft_create_ex(int gpio_device_id, int dma_device_id, XScuGic* p_intc_inst, int s2mm_intr_id, int mm2s_intr_id, int num_pts);
+
+// Brings up every engine of a design for the minimum boot-to-first-transform
+// time. The interrupt controller and exception table are set up once for all
+// engines, and the dma resets are all started before any is waited on, so
+// they run in parallel. Nothing blocks here: each engine finishes coming out
+// of reset on its first transform, or all at once in fft_registry_wait_ready
+fft_registry_t* fft_registry_create(int intc_device_id, const fft_engine_desc_t* p_descs, int num_engines);
+
+void fft_registry_destroy(fft_registry_t* p_reg_inst);
+
+int fft_registry_get_num_engines(fft_registry_t* p_reg_inst);
+
+// engine index, NULL if out of range
+fft_t* fft_registry_get(fft_registry_t* p_reg_inst, int index);
+
+// poll all engines together until every one is ready, FFT_REGISTRY_TIMEOUT if
+// any isn't after timeout_us, FFT_REGISTRY_INIT_FAIL if one failed to come up
+int fft_registry_wait_ready(fft_registry_t* p_reg_inst, int timeout_us);
+
+// global timer ticks from fft_registry_create until fft_registry_wait_ready
+// first returned with every engine ready, 0 if it hasn't
+unsigned long long fft_registry_get_time_to_ready(fft_registry_t* p_reg_inst);
+
+// global timer ticks from fft_registry_create to the first transform done on
+// any engine, 0 if there hasn't been one. Includes however long the
+// application took to start one
+unsigned long long fft_registry_get_time_to_first_fft(fft_registry_t* p_reg_inst);
+
+// time to ready, and to first transform overall and per engine
+void fft_registry_print_startup(fft_registry_t* p_reg_inst);
+
+#endif // FFT_REGISTRY_H
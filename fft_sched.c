@@ -0,0 +1,260 @@
+#include <stdlib.h>
+#include <string.h>
+#include "xtime_l.h"
+#include "fft_sched.h"
+
+typedef struct fft_sched_slot {
+    fft_job_t          job;
+    int                in_use;
+    unsigned int       seq;          // submission order, breaks ties
+    unsigned long long submit_time;
+} fft_sched_slot_t;
+
+typedef struct fft_sched {
+    fft_t*             p_fft_inst;
+    fft_sched_slot_t   slots[FFT_SCHED_MAX_JOBS];
+    int                running;      // slot owned by the engine, or -1
+    int                num_pending;
+    unsigned int       next_seq;
+    fft_sched_stats_t  stats[FFT_SCHED_NUM_PRIOS];
+} fft_sched_t;
+
+static unsigned long long now_ticks(void) {
+    XTime now;
+    XTime_GetTime(&now);
+    return now;
+}
+
+// deadline used for ordering, jobs without one go last
+static unsigned long long effective_deadline(const fft_job_t* p_job) {
+    return (p_job->deadline == FFT_SCHED_NO_DEADLINE) ? ~0ULL : p_job->deadline;
+}
+
+// does slot a go before slot b
+static int runs_before(const fft_sched_slot_t* a, const fft_sched_slot_t* b) {
+    if (a->job.prio != b->job.prio) {
+        return (a->job.prio < b->job.prio);
+    }
+    if (effective_deadline(&a->job) != effective_deadline(&b->job)) {
+        return (effective_deadline(&a->job) < effective_deadline(&b->job));
+    }
+    return ((int)(a->seq - b->seq) < 0);
+}
+
+static int pick_next(fft_sched_t* p_sched_inst) {
+    int best = -1;
+
+    for (int i = 0; i < FFT_SCHED_MAX_JOBS; i++) {
+        if (!p_sched_inst->slots[i].in_use || (i == p_sched_inst->running)) {
+            continue;
+        }
+        if ((best < 0) || runs_before(&p_sched_inst->slots[i], &p_sched_inst->slots[best])) {
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+static void record_latency(fft_sched_stats_t* p_stats, unsigned long long latency) {
+    int bucket = 0;
+
+    while ((bucket < FFT_SCHED_LATENCY_BUCKETS - 1) && ((1ULL << bucket) <= latency)) {
+        bucket++;
+    }
+
+    p_stats->latency_hist[bucket]++;
+    if (latency > p_stats->max_latency_ticks) {
+        p_stats->max_latency_ticks = latency;
+    }
+}
+
+// bookkeeping for the job that just left the engine
+static void retire(fft_sched_t* p_sched_inst, int status) {
+    fft_sched_slot_t*  p_slot  = &p_sched_inst->slots[p_sched_inst->running];
+    fft_sched_stats_t* p_stats = &p_sched_inst->stats[p_slot->job.prio];
+    unsigned long long now     = now_ticks();
+
+    if (status == FFT_SUCCESS) {
+        p_stats->completed++;
+    } else {
+        p_stats->failed++;
+    }
+
+    if ((p_slot->job.deadline != FFT_SCHED_NO_DEADLINE) && (now > p_slot->job.deadline)) {
+        p_stats->deadline_misses++;
+    }
+    record_latency(p_stats, now - p_slot->submit_time);
+
+    // the callback may submit again and reuse the slot, so hand it a copy
+    fft_job_t job = p_slot->job;
+
+    p_slot->in_use = 0;
+    p_sched_inst->running = -1;
+    p_sched_inst->num_pending--;
+
+    if (job.done_fn != NULL) {
+        job.done_fn(&job, status, job.p_ctx);
+    }
+}
+
+// configure the engine for a job and start it
+static int dispatch(fft_sched_t* p_sched_inst, int slot) {
+    fft_t*     p_fft_inst = p_sched_inst->p_fft_inst;
+    fft_job_t* p_job      = &p_sched_inst->slots[slot].job;
+
+    p_sched_inst->running = slot;
+
+    int status = fft_ensure_config(p_fft_inst, p_job->num_pts, p_job->fwd_inv);
+    if (status == FFT_SUCCESS) {
+        int scale_sch = (p_job->scale_sch >= 0) ? p_job->scale_sch : fft_default_scale_sch(fft_get_arch(p_fft_inst), p_job->num_pts);
+        status = fft_set_scale_sch(p_fft_inst, scale_sch);
+    }
+    if (status != FFT_SUCCESS) {
+        return status;
+    }
+
+    // let the dma know how much is lined up behind this frame. num_pending
+    // still counts this job until it completes
+    fft_set_queue_depth(p_fft_inst, p_sched_inst->num_pending - 1);
+
+    return fft_start(p_fft_inst, p_job->din, p_job->dout);
+}
+
+// Public functions
+fft_sched_t* fft_sched_create(fft_t* p_fft_inst) {
+
+    fft_sched_t* p_obj = (fft_sched_t*) malloc(sizeof(fft_sched_t));
+    if (p_obj == NULL) {
+        xil_printf("ERROR! Failed to allocate memory for FFT scheduler object.\n\r");
+        return NULL;
+    }
+
+    p_obj->p_fft_inst  = p_fft_inst;
+    p_obj->running     = -1;
+    p_obj->num_pending = 0;
+    p_obj->next_seq    = 0;
+    for (int i = 0; i < FFT_SCHED_MAX_JOBS; i++) {
+        p_obj->slots[i].in_use = 0;
+    }
+    fft_sched_reset_stats(p_obj);
+
+    return p_obj;
+
+}
+
+void fft_sched_destroy(fft_sched_t* p_sched_inst) {
+    free(p_sched_inst);
+}
+
+int fft_sched_submit(fft_sched_t* p_sched_inst, const fft_job_t* p_job) {
+
+    if ((p_job->prio < 0) || (p_job->prio >= FFT_SCHED_NUM_PRIOS) || (p_job->num_pts > FFT_MAX_NUM_PTS)) {
+        xil_printf("ERROR! Attempted to submit an illegal FFT job.\n\r");
+        return FFT_SCHED_ILLEGAL_JOB;
+    }
+
+    for (int i = 0; i < FFT_SCHED_MAX_JOBS; i++) {
+        fft_sched_slot_t* p_slot = &p_sched_inst->slots[i];
+        if (!p_slot->in_use) {
+            p_slot->job         = *p_job;
+            p_slot->seq         = p_sched_inst->next_seq++;
+            p_slot->submit_time = now_ticks();
+            p_slot->in_use      = 1;
+            p_sched_inst->num_pending++;
+            p_sched_inst->stats[p_job->prio].submitted++;
+            return FFT_SCHED_SUCCESS;
+        }
+    }
+
+    return FFT_SCHED_QUEUE_FULL;
+
+}
+
+int fft_sched_service(fft_sched_t* p_sched_inst) {
+
+    int num_done = 0;
+
+    // frame boundary: the running job has to finish before anything else gets the engine
+    if (p_sched_inst->running >= 0) {
+        int status = fft_poll(p_sched_inst->p_fft_inst);
+        if (status == FFT_BUSY) {
+            return 0;
+        }
+        retire(p_sched_inst, status);
+        num_done++;
+    }
+
+    // start the most urgent queued job. Jobs that fail to start are retired straight away
+    int slot;
+    while ((slot = pick_next(p_sched_inst)) >= 0) {
+        int status = dispatch(p_sched_inst, slot);
+        if (status == FFT_SUCCESS) {
+            break;
+        }
+        xil_printf("ERROR! Failed to start FFT job.\n\r");
+        retire(p_sched_inst, status);
+        num_done++;
+    }
+
+    return num_done;
+
+}
+
+void fft_sched_drain(fft_sched_t* p_sched_inst) {
+    while (p_sched_inst->num_pending > 0) {
+        fft_sched_service(p_sched_inst);
+    }
+}
+
+int fft_sched_pending(fft_sched_t* p_sched_inst) {
+    return (p_sched_inst->num_pending);
+}
+
+void fft_sched_get_stats(fft_sched_t* p_sched_inst, fft_sched_prio_t prio, fft_sched_stats_t* p_stats) {
+    *p_stats = p_sched_inst->stats[prio];
+}
+
+void fft_sched_reset_stats(fft_sched_t* p_sched_inst) {
+    memset(p_sched_inst->stats, 0, sizeof(p_sched_inst->stats));
+}
+
+unsigned long long fft_sched_latency_percentile(fft_sched_t* p_sched_inst, fft_sched_prio_t prio, int percentile) {
+
+    fft_sched_stats_t* p_stats = &p_sched_inst->stats[prio];
+    unsigned int       total   = 0;
+    unsigned int       seen    = 0;
+
+    for (int i = 0; i < FFT_SCHED_LATENCY_BUCKETS; i++) {
+        total += p_stats->latency_hist[i];
+    }
+
+    for (int i = 0; i < FFT_SCHED_LATENCY_BUCKETS; i++) {
+        seen += p_stats->latency_hist[i];
+        if ((total > 0) && ((unsigned long long)seen*100 >= (unsigned long long)total*percentile)) {
+            return (1ULL << i);
+        }
+    }
+
+    return 0;
+
+}
+
+void fft_sched_print_stats(fft_sched_t* p_sched_inst) {
+
+    static const char* prio_names[] = {"critical", "bulk"};
+
+    for (int prio = 0; prio < FFT_SCHED_NUM_PRIOS; prio++) {
+        fft_sched_stats_t* p_stats = &p_sched_inst->stats[prio];
+        unsigned long long p99     = fft_sched_latency_percentile(p_sched_inst, (fft_sched_prio_t)prio, 99);
+
+        xil_printf("%s:\n\r", prio_names[prio]);
+        xil_printf("  submitted       = %d\n\r", p_stats->submitted);
+        xil_printf("  completed       = %d\n\r", p_stats->completed);
+        xil_printf("  failed          = %d\n\r", p_stats->failed);
+        xil_printf("  deadline misses = %d\n\r", p_stats->deadline_misses);
+        xil_printf("  p99 latency     < %d us\n\r", (int)((p99*1000000)/COUNTS_PER_SECOND));
+        xil_printf("  max latency     = %d us\n\r", (int)((p_stats->max_latency_ticks*1000000)/COUNTS_PER_SECOND));
+    }
+
+}
@@ -0,0 +1,85 @@
+#ifndef FFT_SCHED_H
+#define FFT_SCHED_H
+
+#include "fft.h"
+
+#define FFT_SCHED_SUCCESS        0
+#define FFT_SCHED_QUEUE_FULL    -1
+#define FFT_SCHED_ILLEGAL_JOB   -2
+
+// max number of jobs queued or running at once
+#define FFT_SCHED_MAX_JOBS       32
+
+// log2 latency histogram buckets, bucket i counts latencies below 2^i ticks
+#define FFT_SCHED_LATENCY_BUCKETS 40
+
+// no deadline
+#define FFT_SCHED_NO_DEADLINE    0ULL
+
+// lower value is served first
+typedef enum
+{
+    FFT_SCHED_PRIO_CRITICAL = 0,
+    FFT_SCHED_PRIO_BULK     = 1,
+    FFT_SCHED_NUM_PRIOS     = 2
+} fft_sched_prio_t;
+
+typedef struct fft_job fft_job_t;
+
+// called from fft_sched_service when a job is done
+typedef void (*fft_job_done_fn)(const fft_job_t* p_job, int status, void* p_ctx);
+
+struct fft_job
+{
+    complex_sample_t*  din;
+    complex_sample_t*  dout;        // may equal din
+    int                num_pts;
+    fft_fwd_inv_t      fwd_inv;
+    int                scale_sch;   // -1 for the default schedule of the size
+    fft_sched_prio_t   prio;
+    unsigned long long deadline;    // absolute global timer ticks, or FFT_SCHED_NO_DEADLINE
+    fft_job_done_fn    done_fn;     // may be NULL
+    void*              p_ctx;
+};
+
+typedef struct fft_sched_stats
+{
+    int                submitted;
+    int                completed;
+    int                failed;
+    int                deadline_misses;
+    unsigned long long max_latency_ticks;   // submit to completion
+    unsigned int       latency_hist[FFT_SCHED_LATENCY_BUCKETS];
+} fft_sched_stats_t;
+
+typedef struct fft_sched fft_sched_t;
+
+fft_sched_t* fft_sched_create(fft_t* p_fft_inst);
+
+void fft_sched_destroy(fft_sched_t* p_sched_inst);
+
+// queue a job. The job is copied, the buffers must stay valid until it's done
+int fft_sched_submit(fft_sched_t* p_sched_inst, const fft_job_t* p_job);
+
+// retire the running job if it finished and start the next one. Jobs switch
+// only at frame boundaries: critical jobs first, earliest deadline first within
+// a class, then submission order. Call this from the main loop.
+// Returns the number of jobs completed by this call
+int fft_sched_service(fft_sched_t* p_sched_inst);
+
+// service until every queued job is done
+void fft_sched_drain(fft_sched_t* p_sched_inst);
+
+// queued plus running jobs
+int fft_sched_pending(fft_sched_t* p_sched_inst);
+
+void fft_sched_get_stats(fft_sched_t* p_sched_inst, fft_sched_prio_t prio, fft_sched_stats_t* p_stats);
+
+void fft_sched_reset_stats(fft_sched_t* p_sched_inst);
+
+// upper bound in ticks of the given latency percentile (0-100) for a class
+unsigned long long fft_sched_latency_percentile(fft_sched_t* p_sched_inst, fft_sched_prio_t prio, int percentile);
+
+void fft_sched_print_stats(fft_sched_t* p_sched_inst);
+
+#endif // FFT_SCHED_H
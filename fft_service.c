@@ -0,0 +1,189 @@
+#include <string.h>
+#include "fft_service.h"
+
+#define RING_MASK (FFT_SERVICE_RING_SIZE - 1)
+
+// the two sides run on different cores (or processes), so every index update
+// is published with release and read with acquire semantics
+static uint32_t load_acquire(uint32_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(uint32_t* p, uint32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static void kick(fft_service_t* p_svc, int dir) {
+    __atomic_fetch_add(&p_svc->p_shm->doorbell[dir], 1, __ATOMIC_RELEASE);
+    if (p_svc->transport.kick != NULL) {
+        p_svc->transport.kick(p_svc->transport.p_ctx, dir);
+    }
+}
+
+static void wait_kick(fft_service_t* p_svc, int dir, uint32_t seen_count, int timeout_us) {
+    if (p_svc->transport.wait != NULL) {
+        p_svc->transport.wait(p_svc->transport.p_ctx, dir, seen_count, timeout_us);
+    }
+}
+
+static int map_region(fft_service_t* p_svc, const fft_service_transport_t* p_transport) {
+    unsigned int needed = FFT_SERVICE_FRAMES_OFFSET + FFT_SERVICE_NUM_FRAMES*FFT_SERVICE_FRAME_BYTES;
+
+    if ((p_transport->p_shm == NULL) || (p_transport->shm_bytes < needed) || (sizeof(fft_service_shm_t) > FFT_SERVICE_FRAMES_OFFSET)) {
+        return FFT_SERVICE_BAD_REGION;
+    }
+
+    p_svc->transport = *p_transport;
+    p_svc->p_shm     = (fft_service_shm_t*)p_transport->p_shm;
+    p_svc->p_frames  = (complex_sample_t*)((char*)p_transport->p_shm + FFT_SERVICE_FRAMES_OFFSET);
+
+    return FFT_SERVICE_SUCCESS;
+}
+
+// Public functions
+int fft_service_server_init(fft_service_t* p_svc, const fft_service_transport_t* p_transport,
+                            fft_service_handler_fn handler, void* p_handler_ctx) {
+
+    int status = map_region(p_svc, p_transport);
+    if (status != FFT_SERVICE_SUCCESS) {
+        return status;
+    }
+
+    p_svc->handler       = handler;
+    p_svc->p_handler_ctx = p_handler_ctx;
+
+    // format the control block. The magic goes last so a client never sees a half-built region
+    fft_service_shm_t* p_shm = p_svc->p_shm;
+    store_release(&p_shm->magic, 0);
+    memset(p_shm, 0, sizeof(fft_service_shm_t));
+    p_shm->version     = FFT_SERVICE_VERSION;
+    p_shm->num_frames  = FFT_SERVICE_NUM_FRAMES;
+    p_shm->frame_bytes = FFT_SERVICE_FRAME_BYTES;
+    store_release(&p_shm->magic, FFT_SERVICE_MAGIC);
+
+    return FFT_SERVICE_SUCCESS;
+
+}
+
+int fft_service_server_poll(fft_service_t* p_svc, int max_batch) {
+
+    fft_service_shm_t* p_shm   = p_svc->p_shm;
+    uint32_t           tail    = p_shm->req_idx.tail;
+    uint32_t           head    = load_acquire(&p_shm->req_idx.head);
+    int                handled = 0;
+
+    while ((tail != head) && (handled < max_batch)) {
+
+        fft_service_req_t  req = p_shm->req[tail & RING_MASK];
+        fft_service_resp_t resp;
+
+        resp.id          = req.id;
+        resp.frame       = req.frame;
+        resp.scale_shift = 0;
+
+        if (req.frame >= FFT_SERVICE_NUM_FRAMES) {
+            resp.status = FFT_SERVICE_ILLEGAL_FRAME;
+        } else if (req.num_pts > FFT_MAX_NUM_PTS) {
+            resp.status = FFT_ILLEGAL_NUM_PTS;
+        } else {
+            resp.status = p_svc->handler(p_svc->p_handler_ctx, fft_service_frame(p_svc, req.frame), &req, &resp.scale_shift);
+        }
+
+        // release the request slot before waiting on response space
+        tail++;
+        store_release(&p_shm->req_idx.tail, tail);
+
+        // the response ring is as deep as the request ring, and each request
+        // yields one response, so this only spins on a client that stopped reaping
+        uint32_t resp_head = p_shm->resp_idx.head;
+        while (resp_head - load_acquire(&p_shm->resp_idx.tail) >= FFT_SERVICE_RING_SIZE) {
+            kick(p_svc, FFT_SERVICE_TO_CLIENT);
+        }
+        p_shm->resp[resp_head & RING_MASK] = resp;
+        store_release(&p_shm->resp_idx.head, resp_head + 1);
+
+        handled++;
+    }
+
+    // one doorbell per batch
+    if (handled > 0) {
+        kick(p_svc, FFT_SERVICE_TO_CLIENT);
+    }
+
+    return handled;
+
+}
+
+void fft_service_server_run(fft_service_t* p_svc) {
+
+    while (1) {
+        uint32_t seen = load_acquire(&p_svc->p_shm->doorbell[FFT_SERVICE_TO_SERVER]);
+        if (fft_service_server_poll(p_svc, FFT_SERVICE_RING_SIZE) == 0) {
+            wait_kick(p_svc, FFT_SERVICE_TO_SERVER, seen, -1);
+        }
+    }
+
+}
+
+int fft_service_client_attach(fft_service_t* p_svc, const fft_service_transport_t* p_transport) {
+
+    int status = map_region(p_svc, p_transport);
+    if (status != FFT_SERVICE_SUCCESS) {
+        return status;
+    }
+
+    p_svc->handler       = NULL;
+    p_svc->p_handler_ctx = NULL;
+
+    if ((load_acquire(&p_svc->p_shm->magic) != FFT_SERVICE_MAGIC) || (p_svc->p_shm->version != FFT_SERVICE_VERSION)) {
+        return FFT_SERVICE_BAD_REGION;
+    }
+
+    return FFT_SERVICE_SUCCESS;
+
+}
+
+int fft_service_client_submit(fft_service_t* p_svc, const fft_service_req_t* p_req) {
+
+    fft_service_shm_t* p_shm = p_svc->p_shm;
+    uint32_t           head  = p_shm->req_idx.head;
+
+    if (head - load_acquire(&p_shm->req_idx.tail) >= FFT_SERVICE_RING_SIZE) {
+        return FFT_SERVICE_RING_FULL;
+    }
+
+    p_shm->req[head & RING_MASK] = *p_req;
+    store_release(&p_shm->req_idx.head, head + 1);
+
+    kick(p_svc, FFT_SERVICE_TO_SERVER);
+
+    return FFT_SERVICE_SUCCESS;
+
+}
+
+int fft_service_client_reap(fft_service_t* p_svc, fft_service_resp_t* p_resps, int max_resps, int timeout_us) {
+
+    fft_service_shm_t* p_shm = p_svc->p_shm;
+    uint32_t           tail  = p_shm->resp_idx.tail;
+    uint32_t           seen  = load_acquire(&p_shm->doorbell[FFT_SERVICE_TO_CLIENT]);
+    uint32_t           head  = load_acquire(&p_shm->resp_idx.head);
+    int                n     = 0;
+
+    if ((tail == head) && (timeout_us != 0)) {
+        wait_kick(p_svc, FFT_SERVICE_TO_CLIENT, seen, timeout_us);
+        head = load_acquire(&p_shm->resp_idx.head);
+    }
+
+    while ((tail != head) && (n < max_resps)) {
+        p_resps[n++] = p_shm->resp[tail & RING_MASK];
+        tail++;
+    }
+    store_release(&p_shm->resp_idx.tail, tail);
+
+    return n;
+
+}
+
+complex_sample_t* fft_service_frame(fft_service_t* p_svc, int frame) {
+    return (complex_sample_t*)((char*)p_svc->p_frames + frame*FFT_SERVICE_FRAME_BYTES);
+}
@@ -0,0 +1,133 @@
+#ifndef FFT_SERVICE_H
+#define FFT_SERVICE_H
+
+#include <stdint.h>
+#include "complex_sample.h"
+#include "fft.h"
+
+// Shared-memory FFT service. A client (e.g. Linux on the other Cortex-A9)
+// posts requests into a descriptor ring, the server (this firmware) runs the
+// transform in place on a frame buffer inside the shared region and posts a
+// response back. Frame data is never copied. Both sides only depend on this
+// header plus a transport that maps the region and moves doorbells.
+
+#define FFT_SERVICE_SUCCESS          0
+#define FFT_SERVICE_BAD_REGION      -1 // region too small or not formatted by a server
+#define FFT_SERVICE_RING_FULL       -2
+#define FFT_SERVICE_TIMEOUT         -3
+
+// response status the server reports itself, kept clear of the FFT_* codes the
+// handler returns so a client can tell the two apart
+#define FFT_SERVICE_ILLEGAL_FRAME   -128 // frame index past FFT_SERVICE_NUM_FRAMES
+
+#define FFT_SERVICE_MAGIC            0x46465453 // "FFTS"
+#define FFT_SERVICE_VERSION          1
+
+// reserved region in lscript.ld (ps7_ddr_0_fft_shared)
+#define FFT_SERVICE_SHARED_PHYS_ADDR 0x1FE00000
+#define FFT_SERVICE_SHARED_BYTES     0x00200000
+
+// entries per ring, must be a power of 2
+#define FFT_SERVICE_RING_SIZE        64
+#define FFT_SERVICE_NUM_FRAMES       32
+#define FFT_SERVICE_FRAME_BYTES      (FFT_MAX_NUM_PTS*sizeof(complex_sample_t))
+// frames start on their own page, after the control block
+#define FFT_SERVICE_FRAMES_OFFSET    0x1000
+
+// doorbell directions
+#define FFT_SERVICE_TO_SERVER        0
+#define FFT_SERVICE_TO_CLIENT        1
+
+typedef struct fft_service_req
+{
+    uint32_t id;         // chosen by the client, echoed in the response
+    uint32_t frame;      // frame buffer index, transformed in place
+    uint32_t num_pts;
+    uint32_t fwd_inv;    // fft_fwd_inv_t
+    int32_t  scale_sch;  // -1 for the default schedule of the size
+} fft_service_req_t;
+
+typedef struct fft_service_resp
+{
+    uint32_t id;
+    uint32_t frame;
+    int32_t  status;      // FFT_SUCCESS, an FFT_* error from the handler (FFT_ILLEGAL_NUM_PTS
+                          // also for sizes the frames can't hold), or FFT_SERVICE_ILLEGAL_FRAME
+    uint32_t scale_shift; // total right shift applied by the schedule
+} fft_service_resp_t;
+
+// head and tail sit on separate cache lines so producer and consumer never share one
+typedef struct fft_service_ring_idx
+{
+    uint32_t head;       // written by the producer only
+    uint32_t pad0[7];
+    uint32_t tail;       // written by the consumer only
+    uint32_t pad1[7];
+} fft_service_ring_idx_t;
+
+// control block at the start of the shared region
+typedef struct fft_service_shm
+{
+    uint32_t               magic;
+    uint32_t               version;
+    uint32_t               num_frames;
+    uint32_t               frame_bytes;
+    uint32_t               doorbell[2];   // bumped on every kick, indexed by direction
+    uint32_t               pad[2];
+    fft_service_ring_idx_t req_idx;
+    fft_service_ring_idx_t resp_idx;
+    fft_service_req_t      req[FFT_SERVICE_RING_SIZE];
+    fft_service_resp_t     resp[FFT_SERVICE_RING_SIZE];
+} fft_service_shm_t;
+
+// how a side reaches the region and the other side
+typedef struct fft_service_transport
+{
+    void*        p_shm;
+    unsigned int shm_bytes;
+    void*        p_ctx;
+    // wake the other side. dir is the direction the message travels
+    void         (*kick)(void* p_ctx, int dir);
+    // sleep until a kick in direction dir arrives after seen_count was read, or timeout.
+    // timeout_us < 0 waits forever
+    void         (*wait)(void* p_ctx, int dir, uint32_t seen_count, int timeout_us);
+} fft_service_transport_t;
+
+// server side handler: transform frame in place according to p_req, returns an
+// FFT_* status and the total scale shift applied
+typedef int (*fft_service_handler_fn)(void* p_ctx, complex_sample_t* frame, const fft_service_req_t* p_req,
+                                      uint32_t* p_scale_shift);
+
+typedef struct fft_service
+{
+    fft_service_transport_t transport;
+    fft_service_shm_t*      p_shm;
+    complex_sample_t*       p_frames;
+    fft_service_handler_fn  handler;
+    void*                   p_handler_ctx;
+} fft_service_t;
+
+// server: format the region and start accepting requests
+int fft_service_server_init(fft_service_t* p_svc, const fft_service_transport_t* p_transport,
+                            fft_service_handler_fn handler, void* p_handler_ctx);
+
+// server: handle up to max_batch queued requests without blocking. Returns how many were handled
+int fft_service_server_poll(fft_service_t* p_svc, int max_batch);
+
+// server: handle requests forever, sleeping on the doorbell when idle
+void fft_service_server_run(fft_service_t* p_svc);
+
+// client: attach to a region formatted by a server
+int fft_service_client_attach(fft_service_t* p_svc, const fft_service_transport_t* p_transport);
+
+// client: queue a request. The frame must not be touched until its response arrives
+int fft_service_client_submit(fft_service_t* p_svc, const fft_service_req_t* p_req);
+
+// client: collect up to max_resps responses, waiting up to timeout_us for the first one.
+// Returns the number collected (0 on timeout)
+int fft_service_client_reap(fft_service_t* p_svc, fft_service_resp_t* p_resps, int max_resps, int timeout_us);
+
+// either side: frame buffer by index
+complex_sample_t* fft_service_frame(fft_service_t* p_svc, int frame);
+
+#endif // FFT_SERVICE_H
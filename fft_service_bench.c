@@ -0,0 +1,123 @@
+#ifdef __linux__
+
+// Host test of the shared-memory FFT service protocol: forks a server process
+// with a loopback handler and drives it from a client process, checking every
+// response and reporting request throughput.
+//
+//   gcc -O2 -o fft_service_bench fft_service_bench.c fft_service.c fft_service_posix.c -lrt -pthread
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "fft_service_posix.h"
+
+#define BENCH_SHM_NAME "/fft_service_bench"
+
+// stands in for the hardware engine: marks the frame so the client can tell it was handled
+static int loopback_handler(void* p_ctx, complex_sample_t* frame, const fft_service_req_t* p_req, uint32_t* p_scale_shift) {
+    frame[0].data_re = (short)p_req->id;
+    frame[0].data_im = (short)~p_req->id;
+    *p_scale_shift   = 0;
+    return FFT_SUCCESS;
+}
+
+static int run_server(void) {
+    fft_service_posix_t     posix;
+    fft_service_transport_t transport;
+    fft_service_t           svc;
+
+    if (fft_service_posix_open(&posix, BENCH_SHM_NAME, 0, &transport) != FFT_SERVICE_SUCCESS) {
+        return 1;
+    }
+    if (fft_service_server_init(&svc, &transport, loopback_handler, NULL) != FFT_SERVICE_SUCCESS) {
+        return 1;
+    }
+    fft_service_server_run(&svc);
+    return 0;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+int main(int argc, char** argv) {
+
+    int                     num_reqs = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int                     num_pts  = (argc > 2) ? atoi(argv[2]) : 1024;
+    fft_service_posix_t     posix;
+    fft_service_transport_t transport;
+    fft_service_t           svc;
+    fft_service_resp_t      resps[FFT_SERVICE_RING_SIZE];
+    int                     errors = 0;
+
+    // the parent owns the objects so they outlive the server
+    if (fft_service_posix_open(&posix, BENCH_SHM_NAME, 1, &transport) != FFT_SERVICE_SUCCESS) {
+        return 1;
+    }
+    ((fft_service_shm_t*)transport.p_shm)->magic = 0;
+
+    pid_t server = fork();
+    if (server == 0) {
+        return run_server();
+    }
+
+    // wait for the server to format the region
+    while (fft_service_client_attach(&svc, &transport) != FFT_SERVICE_SUCCESS) {
+        usleep(1000);
+    }
+
+    double start     = now_sec();
+    int    submitted = 0;
+    int    completed = 0;
+    int    in_flight = 0;
+
+    while (completed < num_reqs) {
+
+        // keep every frame busy
+        while ((submitted < num_reqs) && (in_flight < FFT_SERVICE_NUM_FRAMES)) {
+            fft_service_req_t req;
+            req.id        = submitted;
+            req.frame     = submitted % FFT_SERVICE_NUM_FRAMES;
+            req.num_pts   = num_pts;
+            req.fwd_inv   = FFT_FORWARD;
+            req.scale_sch = -1;
+            if (fft_service_client_submit(&svc, &req) != FFT_SERVICE_SUCCESS) {
+                break;
+            }
+            submitted++;
+            in_flight++;
+        }
+
+        int n = fft_service_client_reap(&svc, resps, FFT_SERVICE_RING_SIZE, 100000);
+        for (int i = 0; i < n; i++) {
+            complex_sample_t* frame = fft_service_frame(&svc, resps[i].frame);
+            if ((resps[i].id != (uint32_t)completed) || (resps[i].status != FFT_SUCCESS) ||
+                (frame[0].data_re != (short)resps[i].id) || (frame[0].data_im != (short)~resps[i].id)) {
+                errors++;
+            }
+            completed++;
+            in_flight--;
+        }
+    }
+
+    double elapsed = now_sec() - start;
+
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+    fft_service_posix_close(&posix);
+
+    printf("requests      : %d\n", num_reqs);
+    printf("errors        : %d\n", errors);
+    printf("requests/s    : %.0f\n", num_reqs/elapsed);
+    printf("frame MB/s    : %.1f (zero-copy, %d-point frames)\n", num_reqs/elapsed*num_pts*sizeof(complex_sample_t)/1e6, num_pts);
+
+    return (errors == 0) ? 0 : 1;
+
+}
+
+#endif // __linux__
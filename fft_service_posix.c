@@ -0,0 +1,178 @@
+#ifdef __linux__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "fft_service_posix.h"
+
+static void sem_name(char* out, size_t len, const char* name, int dir) {
+    snprintf(out, len, "%s.db%d", name, dir);
+}
+
+static void posix_kick(void* p_ctx, int dir) {
+    fft_service_posix_t* p_posix = (fft_service_posix_t*)p_ctx;
+    sem_post((sem_t*)p_posix->p_doorbell[dir]);
+}
+
+static void posix_wait(void* p_ctx, int dir, uint32_t seen_count, int timeout_us) {
+    fft_service_posix_t* p_posix = (fft_service_posix_t*)p_ctx;
+    fft_service_shm_t*   p_shm   = (fft_service_shm_t*)p_posix->p_shm;
+    struct timespec      deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    if (timeout_us >= 0) {
+        deadline.tv_sec  += timeout_us / 1000000;
+        deadline.tv_nsec += (long)(timeout_us % 1000000)*1000;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    // the semaphore may hold stale posts, so the doorbell count is what decides
+    while (__atomic_load_n(&p_shm->doorbell[dir], __ATOMIC_ACQUIRE) == seen_count) {
+        int rc = (timeout_us >= 0) ? sem_timedwait((sem_t*)p_posix->p_doorbell[dir], &deadline)
+                                   : sem_wait((sem_t*)p_posix->p_doorbell[dir]);
+        if ((rc != 0) && (errno == ETIMEDOUT)) {
+            return;
+        }
+    }
+}
+
+static void devmem_kick(void* p_ctx, int dir) {
+#if defined(__arm__)
+    __asm__ __volatile__("dsb\n\tsev" ::: "memory");
+#endif
+}
+
+static void devmem_wait(void* p_ctx, int dir, uint32_t seen_count, int timeout_us) {
+    fft_service_posix_t* p_posix = (fft_service_posix_t*)p_ctx;
+    fft_service_shm_t*   p_shm   = (fft_service_shm_t*)p_posix->p_shm;
+    struct timespec      start, now;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (__atomic_load_n(&p_shm->doorbell[dir], __ATOMIC_ACQUIRE) == seen_count) {
+        if (timeout_us >= 0) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            long long elapsed_us = (now.tv_sec - start.tv_sec)*1000000LL + (now.tv_nsec - start.tv_nsec)/1000;
+            if (elapsed_us >= timeout_us) {
+                return;
+            }
+        }
+        sched_yield();
+    }
+}
+
+// Public functions
+int fft_service_posix_open(fft_service_posix_t* p_posix, const char* name, int create,
+                           fft_service_transport_t* p_transport) {
+
+    char sem_path[80];
+    int  flags = create ? (O_CREAT | O_RDWR) : O_RDWR;
+
+    memset(p_posix, 0, sizeof(fft_service_posix_t));
+    snprintf(p_posix->name, sizeof(p_posix->name), "%s", name);
+    p_posix->owner = create;
+
+    int fd = shm_open(name, flags, 0600);
+    if (fd < 0) {
+        perror("ERROR! shm_open");
+        return FFT_SERVICE_BAD_REGION;
+    }
+    if (create && (ftruncate(fd, FFT_SERVICE_SHARED_BYTES) != 0)) {
+        perror("ERROR! ftruncate");
+        close(fd);
+        return FFT_SERVICE_BAD_REGION;
+    }
+
+    p_posix->p_shm = mmap(NULL, FFT_SERVICE_SHARED_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p_posix->p_shm == MAP_FAILED) {
+        perror("ERROR! mmap");
+        p_posix->p_shm = NULL;
+        return FFT_SERVICE_BAD_REGION;
+    }
+
+    for (int dir = 0; dir < 2; dir++) {
+        sem_name(sem_path, sizeof(sem_path), name, dir);
+        p_posix->p_doorbell[dir] = create ? sem_open(sem_path, O_CREAT, 0600, 0) : sem_open(sem_path, 0);
+        if (p_posix->p_doorbell[dir] == SEM_FAILED) {
+            perror("ERROR! sem_open");
+            p_posix->p_doorbell[dir] = NULL;
+            fft_service_posix_close(p_posix);
+            return FFT_SERVICE_BAD_REGION;
+        }
+    }
+
+    p_transport->p_shm     = p_posix->p_shm;
+    p_transport->shm_bytes = FFT_SERVICE_SHARED_BYTES;
+    p_transport->p_ctx     = p_posix;
+    p_transport->kick      = posix_kick;
+    p_transport->wait      = posix_wait;
+
+    return FFT_SERVICE_SUCCESS;
+
+}
+
+int fft_service_devmem_open(fft_service_posix_t* p_posix, fft_service_transport_t* p_transport) {
+
+    memset(p_posix, 0, sizeof(fft_service_posix_t));
+
+    // O_SYNC gives an uncached mapping, matching the attributes the firmware uses
+    int fd = open("/dev/mem", O_RDWR | O_SYNC);
+    if (fd < 0) {
+        perror("ERROR! open /dev/mem");
+        return FFT_SERVICE_BAD_REGION;
+    }
+
+    p_posix->p_shm = mmap(NULL, FFT_SERVICE_SHARED_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, FFT_SERVICE_SHARED_PHYS_ADDR);
+    close(fd);
+    if (p_posix->p_shm == MAP_FAILED) {
+        perror("ERROR! mmap /dev/mem");
+        p_posix->p_shm = NULL;
+        return FFT_SERVICE_BAD_REGION;
+    }
+
+    p_transport->p_shm     = p_posix->p_shm;
+    p_transport->shm_bytes = FFT_SERVICE_SHARED_BYTES;
+    p_transport->p_ctx     = p_posix;
+    p_transport->kick      = devmem_kick;
+    p_transport->wait      = devmem_wait;
+
+    return FFT_SERVICE_SUCCESS;
+
+}
+
+void fft_service_posix_close(fft_service_posix_t* p_posix) {
+
+    char sem_path[80];
+
+    for (int dir = 0; dir < 2; dir++) {
+        if (p_posix->p_doorbell[dir] != NULL) {
+            sem_close((sem_t*)p_posix->p_doorbell[dir]);
+            p_posix->p_doorbell[dir] = NULL;
+        }
+        if (p_posix->owner) {
+            sem_name(sem_path, sizeof(sem_path), p_posix->name, dir);
+            sem_unlink(sem_path);
+        }
+    }
+
+    if (p_posix->p_shm != NULL) {
+        munmap(p_posix->p_shm, FFT_SERVICE_SHARED_BYTES);
+        p_posix->p_shm = NULL;
+    }
+
+    if (p_posix->owner) {
+        shm_unlink(p_posix->name);
+    }
+
+}
+
+#endif // __linux__
@@ -0,0 +1,27 @@
+#ifndef FFT_SERVICE_POSIX_H
+#define FFT_SERVICE_POSIX_H
+
+#include "fft_service.h"
+
+// Linux transports for the shared-memory FFT service
+
+// POSIX shared memory plus two named semaphores as doorbells, for running both
+// sides as processes on a plain Linux box. The server side creates the objects
+typedef struct fft_service_posix
+{
+    char  name[64];
+    int   owner;
+    void* p_shm;
+    void* p_doorbell[2];   // sem_t*, indexed by direction
+} fft_service_posix_t;
+
+int fft_service_posix_open(fft_service_posix_t* p_posix, const char* name, int create,
+                           fft_service_transport_t* p_transport);
+
+// client on Linux running next to the firmware: maps the reserved region
+// through /dev/mem. Doorbells are polled with sev from the client side
+int fft_service_devmem_open(fft_service_posix_t* p_posix, fft_service_transport_t* p_transport);
+
+void fft_service_posix_close(fft_service_posix_t* p_posix);
+
+#endif // FFT_SERVICE_POSIX_H
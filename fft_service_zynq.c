@@ -0,0 +1,75 @@
+#include "xil_mmu.h"
+#include "xtime_l.h"
+#include "fft_service_zynq.h"
+
+// shareable, normal, non-cacheable. Both cores see every access without any
+// cache maintenance, and the dma flushes on frame buffers become no-ops
+#define FFT_SERVICE_SHM_ATTR 0x14DE2
+#define MMU_SECTION_BYTES    0x00100000
+
+// reserved in lscript.ld
+extern char _fft_shared_base[];
+
+// sev wakes the other core out of wfe. The dsb makes the doorbell store visible first
+static void zynq_kick(void* p_ctx, int dir) {
+    __asm__ __volatile__("dsb\n\tsev" ::: "memory");
+}
+
+static void zynq_wait(void* p_ctx, int dir, uint32_t seen_count, int timeout_us) {
+    fft_service_shm_t* p_shm = (fft_service_shm_t*)p_ctx;
+    XTime              start, now;
+
+    XTime_GetTime(&start);
+    while (__atomic_load_n(&p_shm->doorbell[dir], __ATOMIC_ACQUIRE) == seen_count) {
+        if (timeout_us >= 0) {
+            XTime_GetTime(&now);
+            if ((now - start) >= ((XTime)timeout_us*COUNTS_PER_SECOND)/1000000) {
+                return;
+            }
+        }
+        __asm__ __volatile__("wfe" ::: "memory");
+    }
+}
+
+// run the request on the hardware engine, in place on the shared frame
+static int zynq_handler(void* p_ctx, complex_sample_t* frame, const fft_service_req_t* p_req, uint32_t* p_scale_shift) {
+    fft_t* p_fft_inst = (fft_t*)p_ctx;
+    int    status     = fft_ensure_config(p_fft_inst, p_req->num_pts, (fft_fwd_inv_t)p_req->fwd_inv);
+
+    if ((status == FFT_SUCCESS) && (p_req->scale_sch >= 0)) {
+        status = fft_set_scale_sch(p_fft_inst, p_req->scale_sch);
+    } else if (status == FFT_SUCCESS) {
+        status = fft_set_scale_sch(p_fft_inst, fft_default_scale_sch(fft_get_arch(p_fft_inst), p_req->num_pts));
+    }
+    if (status != FFT_SUCCESS) {
+        return status;
+    }
+
+    *p_scale_shift = fft_get_scale_shift(p_fft_inst);
+
+    return fft(p_fft_inst, frame, frame);
+}
+
+// Public functions
+int fft_service_zynq_init(fft_service_t* p_svc, fft_t* p_fft_inst) {
+
+    fft_service_transport_t transport;
+
+    for (unsigned int offset = 0; offset < FFT_SERVICE_SHARED_BYTES; offset += MMU_SECTION_BYTES) {
+        Xil_SetTlbAttributes((INTPTR)(_fft_shared_base + offset), FFT_SERVICE_SHM_ATTR);
+    }
+
+    transport.p_shm     = _fft_shared_base;
+    transport.shm_bytes = FFT_SERVICE_SHARED_BYTES;
+    transport.p_ctx     = _fft_shared_base;
+    transport.kick      = zynq_kick;
+    transport.wait      = zynq_wait;
+
+    int status = fft_service_server_init(p_svc, &transport, zynq_handler, p_fft_inst);
+    if (status != FFT_SERVICE_SUCCESS) {
+        xil_printf("ERROR! Failed to initialize the shared-memory FFT service.\n\r");
+    }
+
+    return status;
+
+}
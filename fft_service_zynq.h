@@ -0,0 +1,11 @@
+#ifndef FFT_SERVICE_ZYNQ_H
+#define FFT_SERVICE_ZYNQ_H
+
+#include "fft_service.h"
+
+// bare-metal server over the region reserved in lscript.ld. Requests are run
+// in place on p_fft_inst; doorbells are sev/wfe between the two cores.
+// Call fft_service_server_run (or _poll from the main loop) afterwards
+int fft_service_zynq_init(fft_service_t* p_svc, fft_t* p_fft_inst);
+
+#endif // FFT_SERVICE_ZYNQ_H
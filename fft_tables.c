@@ -0,0 +1,181 @@
+#include <stddef.h>
+#include <math.h>
+#include "xil_printf.h"
+#include "xil_mmu.h"
+#include "fft_tables.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// normal, write-back cached, read-only at every privilege level (AP[2] set)
+#define FFT_TABLES_RO_ATTR   0x1DDE6
+#define MMU_SECTION_BYTES    0x00100000
+
+#define FFT_TABLES_SECTION   __attribute__((section(".fft_tables"), aligned(DMA_ACCEL_BUF_ALIGN)))
+
+// Each type keeps every size back to back, smallest first. The sizes below N add
+// up to N - 16 entries (N/2 - 8 for the half-length split tables), which makes
+// that the offset of the N-point table, and every table starts on a cache line
+#define FFT_TABLES_FULL_ENTRIES  (2*FFT_MAX_NUM_PTS - FFT_TABLES_MIN_NUM_PTS)
+#define FFT_TABLES_HALF_ENTRIES  (FFT_MAX_NUM_PTS - FFT_TABLES_MIN_NUM_PTS/2)
+
+static complex_sample_t g_twiddle[2][FFT_TABLES_FULL_ENTRIES]    FFT_TABLES_SECTION;
+static complex_sample_t g_real_split[2][FFT_TABLES_HALF_ENTRIES] FFT_TABLES_SECTION;
+static short            g_window[FFT_TABLES_FULL_ENTRIES]        FFT_TABLES_SECTION;
+
+// bit log2(N) set once the N-point table is generated. Kept out of the table
+// section, which is NOLOAD and may be locked
+static unsigned int g_valid[FFT_TABLE_NUM_TYPES][2];
+static int          g_locked;
+
+// reserved in lscript.ld
+extern char __fft_tables_start[];
+extern char __fft_tables_end[];
+
+static short to_q15(double x) {
+    long v = lround(x * 32768.0);
+    if (v > 32767) {
+        return 32767;
+    } else if (v < -32768) {
+        return -32768;
+    }
+    return (short)v;
+}
+
+// W_N^k with the sign of the direction, k < num_entries
+static void gen_twiddle(complex_sample_t* p_table, int num_pts, int num_entries, fft_fwd_inv_t fwd_inv) {
+    double sign = (fwd_inv == FFT_FORWARD) ? -1.0 : 1.0;
+
+    for (int k = 0; k < num_entries; k++) {
+        double angle = 2.0*M_PI*k/num_pts;
+        p_table[k].data_re = to_q15(cos(angle));
+        p_table[k].data_im = to_q15(sign*sin(angle));
+    }
+}
+
+static void gen_window(short* p_table, int num_pts) {
+    for (int n = 0; n < num_pts; n++) {
+        p_table[n] = to_q15(0.5 - 0.5*cos(2.0*M_PI*n/num_pts));
+    }
+}
+
+static int is_table_size(int num_pts) {
+    return (num_pts >= FFT_TABLES_MIN_NUM_PTS) && (num_pts <= FFT_MAX_NUM_PTS) && ((num_pts & (num_pts - 1)) == 0);
+}
+
+// Public functions
+const void* fft_tables_get(int num_pts, fft_fwd_inv_t fwd_inv, fft_table_type_t type) {
+
+    if (!is_table_size(num_pts) || ((fwd_inv != FFT_FORWARD) && (fwd_inv != FFT_INVERSE)) ||
+        (type < 0) || (type >= FFT_TABLE_NUM_TYPES)) {
+        xil_printf("ERROR! No FFT table of type %d for %d points.\n\r", type, num_pts);
+        return NULL;
+    }
+
+    // the window doesn't depend on the direction, keep one copy
+    int          dir = (type == FFT_TABLE_WINDOW) ? FFT_FORWARD : fwd_inv;
+    unsigned int bit = 1u << __builtin_ctz(num_pts);
+    const void*  p_table;
+
+    switch (type) {
+        case FFT_TABLE_TWIDDLE:    p_table = &g_twiddle[dir][num_pts - FFT_TABLES_MIN_NUM_PTS];              break;
+        case FFT_TABLE_REAL_SPLIT: p_table = &g_real_split[dir][(num_pts - FFT_TABLES_MIN_NUM_PTS)/2];     break;
+        default:                   p_table = &g_window[num_pts - FFT_TABLES_MIN_NUM_PTS];                  break;
+    }
+
+    if (g_valid[type][dir] & bit) {
+        return p_table;
+    }
+
+    if (g_locked) {
+        xil_printf("ERROR! FFT table of type %d for %d points was not generated before the tables were locked.\n\r", type, num_pts);
+        return NULL;
+    }
+
+    switch (type) {
+        case FFT_TABLE_TWIDDLE:    gen_twiddle((complex_sample_t*)p_table, num_pts, num_pts, (fft_fwd_inv_t)dir);   break;
+        case FFT_TABLE_REAL_SPLIT: gen_twiddle((complex_sample_t*)p_table, num_pts, num_pts/2, (fft_fwd_inv_t)dir); break;
+        default:                   gen_window((short*)p_table, num_pts);                                             break;
+    }
+    g_valid[type][dir] |= bit;
+
+    return p_table;
+
+}
+
+const complex_sample_t* fft_tables_twiddle(int num_pts, fft_fwd_inv_t fwd_inv) {
+    return (const complex_sample_t*)fft_tables_get(num_pts, fwd_inv, FFT_TABLE_TWIDDLE);
+}
+
+const complex_sample_t* fft_tables_real_split(int num_pts, fft_fwd_inv_t fwd_inv) {
+    return (const complex_sample_t*)fft_tables_get(num_pts, fwd_inv, FFT_TABLE_REAL_SPLIT);
+}
+
+const short* fft_tables_window(int num_pts) {
+    return (const short*)fft_tables_get(num_pts, FFT_FORWARD, FFT_TABLE_WINDOW);
+}
+
+int fft_tables_prewarm(int max_num_pts) {
+
+    if (!is_table_size(max_num_pts)) {
+        xil_printf("ERROR! Can't prewarm FFT tables up to %d points.\n\r", max_num_pts);
+        return FFT_TABLES_ILLEGAL_PARAMS;
+    }
+
+    for (int num_pts = FFT_TABLES_MIN_NUM_PTS; num_pts <= max_num_pts; num_pts *= 2) {
+        if ((fft_tables_twiddle(num_pts, FFT_FORWARD) == NULL) || (fft_tables_twiddle(num_pts, FFT_INVERSE) == NULL) ||
+            (fft_tables_real_split(num_pts, FFT_FORWARD) == NULL) || (fft_tables_real_split(num_pts, FFT_INVERSE) == NULL) ||
+            (fft_tables_window(num_pts) == NULL)) {
+            return FFT_TABLES_LOCKED;
+        }
+    }
+
+    return FFT_TABLES_SUCCESS;
+
+}
+
+int fft_tables_lock(void) {
+
+    // the section is mmu section aligned at both ends, so this touches nothing else
+    for (char* p = __fft_tables_start; p < __fft_tables_end; p += MMU_SECTION_BYTES) {
+        Xil_SetTlbAttributes((INTPTR)p, FFT_TABLES_RO_ATTR);
+    }
+    g_locked = 1;
+
+    return FFT_TABLES_SUCCESS;
+
+}
+
+int fft_tables_apply_window(complex_sample_t* dst, const complex_sample_t* src, int num_pts) {
+
+    const short* p_win = fft_tables_window(num_pts);
+    if (p_win == NULL) {
+        return FFT_TABLES_ILLEGAL_PARAMS;
+    }
+
+    int k = 0;
+
+#ifdef __ARM_NEON
+    // vqrdmulh is the rounded, saturated Q15 product
+    for (; k + 8 <= num_pts; k += 8) {
+        int16x8x2_t x = vld2q_s16((const int16_t*)&src[k]);
+        int16x8_t   w = vld1q_s16(&p_win[k]);
+
+        x.val[0] = vqrdmulhq_s16(x.val[0], w);
+        x.val[1] = vqrdmulhq_s16(x.val[1], w);
+        vst2q_s16((int16_t*)&dst[k], x);
+    }
+#endif
+
+    for (; k < num_pts; k++) {
+        dst[k].data_re = (short)((src[k].data_re*p_win[k]*2 + (1 << 15)) >> 16);
+        dst[k].data_im = (short)((src[k].data_im*p_win[k]*2 + (1 << 15)) >> 16);
+    }
+
+    return FFT_TABLES_SUCCESS;
+
+}
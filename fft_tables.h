@@ -0,0 +1,54 @@
+#ifndef FFT_TABLES_H
+#define FFT_TABLES_H
+
+#include "complex_sample.h"
+#include "fft.h"
+
+#define FFT_TABLES_SUCCESS         0
+#define FFT_TABLES_ILLEGAL_PARAMS -1
+#define FFT_TABLES_LOCKED         -2
+
+// every power of 2 from here up to FFT_MAX_NUM_PTS has its tables
+#define FFT_TABLES_MIN_NUM_PTS     16
+
+// Size-indexed cache of the tables the stages around the engine need. Each
+// (size, direction, type) table is generated on first use into the .fft_tables
+// section (see lscript.ld) and then only looked up, so switching sizes at run
+// time costs nothing and no trig runs after the first frame. Call
+// fft_tables_prewarm at startup to take that first frame cost up front too.
+// The tables are Q15, for fixed-point stages on the engine's samples; float
+// recursions like sdft need more precision than they hold.
+// Main loop only, not from an isr.
+
+typedef enum
+{
+    // e^(-j2pi k/N) forward, e^(+j2pi k/N) inverse, k < N. Q15
+    FFT_TABLE_TWIDDLE    = 0,
+    // e^(-+j2pi k/N) for k < N/2, to split an N/2-point complex transform of
+    // packed real data into the N-point real spectrum. Q15
+    FFT_TABLE_REAL_SPLIT = 1,
+    // periodic hann window, N shorts in Q15. The same for both directions
+    FFT_TABLE_WINDOW     = 2,
+    FFT_TABLE_NUM_TYPES
+} fft_table_type_t;
+
+// table for an N-point transform, NULL if N isn't a covered size or the table
+// wasn't generated before fft_tables_lock
+const void* fft_tables_get(int num_pts, fft_fwd_inv_t fwd_inv, fft_table_type_t type);
+
+const complex_sample_t* fft_tables_twiddle(int num_pts, fft_fwd_inv_t fwd_inv);
+
+const complex_sample_t* fft_tables_real_split(int num_pts, fft_fwd_inv_t fwd_inv);
+
+const short* fft_tables_window(int num_pts);
+
+// generate every table from FFT_TABLES_MIN_NUM_PTS up to max_num_pts
+int fft_tables_prewarm(int max_num_pts);
+
+// map the table section read-only. Tables not generated by then stay unavailable
+int fft_tables_lock(void);
+
+// dst = src * window, rounded and saturated. dst may be src
+int fft_tables_apply_window(complex_sample_t* dst, const complex_sample_t* src, int num_pts);
+
+#endif // FFT_TABLES_H
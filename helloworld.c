@@ -3,8 +3,11 @@
 #include "platform.h"
 #include "xuartps_hw.h"
 #include "fft.h"
+#include "fft_registry.h"
 #include "complex_sample.h"
 #include "input_samples.h"
+#include "fft_service_zynq.h"
+#include "trace.h"
 
 // input_samples.h
 extern int sig_two_sine_waves[FFT_MAX_NUM_PTS];
@@ -17,20 +20,34 @@ int main() {
     init_platform();
     xil_printf("\fHello World!\n\r");
 
-    // fft object
-    fft_t* p_fft_inst = fft_create(
-        XPAR_GPIO_0_DEVICE_ID,
-        XPAR_AXIDMA_0_DEVICE_ID,
-        XPAR_PS7_SCUGIC_0_DEVICE_ID,
-        XPAR_FABRIC_CTRL_AXI_DMA_0_S2MM_INTROUT_INTR,
-        XPAR_FABRIC_CTRL_AXI_DMA_0_MM2S_INTROUT_INTR
-    );
-
-    if (p_fft_inst == NULL) {
+    // fft engines in the design. The dma finishes its reset in the background
+    static const fft_engine_desc_t engines[] = {
+        {
+            XPAR_GPIO_0_DEVICE_ID,
+            XPAR_AXIDMA_0_DEVICE_ID,
+            XPAR_FABRIC_CTRL_AXI_DMA_0_S2MM_INTROUT_INTR,
+            XPAR_FABRIC_CTRL_AXI_DMA_0_MM2S_INTROUT_INTR,
+            1024
+        }
+    };
+
+    fft_registry_t* p_fft_reg = fft_registry_create(XPAR_PS7_SCUGIC_0_DEVICE_ID, engines, sizeof(engines)/sizeof(engines[0]));
+    if (p_fft_reg == NULL) {
         xil_printf("ERROR! Failed to create FFT instance.\n\r");
         return -1;
     }
 
+    // bring-up time, before anything waits on the user
+    if (fft_registry_wait_ready(p_fft_reg, DMA_ACCEL_RESET_TIMEOUT_US) != FFT_REGISTRY_SUCCESS) {
+        xil_printf("ERROR! FFT engines did not come out of reset.\n\r");
+        return -1;
+    }
+    fft_registry_print_startup(p_fft_reg);
+
+    // fft object
+    fft_t* p_fft_inst = fft_registry_get(p_fft_reg, 0);
+    int    first_fft  = 1;
+
     // data buffers
     complex_sample_t* input_buf = (complex_sample_t*) malloc(sizeof(complex_sample_t)*FFT_MAX_NUM_PTS);
     if (input_buf == NULL) {
@@ -44,6 +61,10 @@ int main() {
         return -1;
     }
 
+#ifdef TRACE_ENABLE
+    trace_start();
+#endif
+
     // fill input buffer with some signal
     memcpy(input_buf, sig_two_sine_waves, sizeof(complex_sample_t)*FFT_MAX_NUM_PTS);
 
@@ -55,7 +76,11 @@ int main() {
         xil_printf("2: Perform FFT using current parameters\n\r");
         xil_printf("3: Print current inputulus to be used for the FFT operation\n\r");
         xil_printf("4: Print outputs of previous FFT operation\n\r");
-        xil_printf("5: Quit\n\r");
+        xil_printf("5: Serve FFT requests from the other core over shared memory\n\r");
+#ifdef TRACE_ENABLE
+        xil_printf("6: Dump the activity trace (binary) and restart it\n\r");
+#endif
+        xil_printf("7: Quit\n\r");
         char c = XUartPs_RecvByte(XPAR_PS7_UART_1_BASEADDR);
 
         if (c == '0') {
@@ -76,11 +101,31 @@ int main() {
             }
 
             xil_printf("FFT complete!\n\r");
+            if (first_fft) {
+                fft_registry_print_startup(p_fft_reg);
+                first_fft = 0;
+            }
         } else if (c == '3') {
             fft_print_input_buf(p_fft_inst);
         } else if (c == '4') {
+            TRACE_BEGIN(TRACE_EV_USER, TRACE_TRACK_CPU, 0);
             fft_print_output_buf(p_fft_inst);
+            TRACE_END(TRACE_EV_USER, TRACE_TRACK_CPU, 0);
         } else if (c == '5') {
+            fft_service_t svc;
+            if (fft_service_zynq_init(&svc, p_fft_inst) != FFT_SERVICE_SUCCESS) {
+                xil_printf("ERROR! Failed to start the FFT service.\n\r");
+                continue;
+            }
+            xil_printf("Serving FFT requests. Reset the board to get back to this menu.\n\r");
+            fft_service_server_run(&svc);
+#ifdef TRACE_ENABLE
+        } else if (c == '6') {
+            trace_stop();
+            trace_dump_uart(XPAR_PS7_UART_1_BASEADDR);
+            trace_start();
+#endif
+        } else if (c == '7') {
             xil_printf("Okay, exiting...\n\r");
             break;
         } else {
@@ -91,7 +136,7 @@ int main() {
 
     free(input_buf);
     free(output_buf);
-    fft_destroy(p_fft_inst);
+    fft_registry_destroy(p_fft_reg);
 
     return 0;
 
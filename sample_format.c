@@ -0,0 +1,257 @@
+#include <stddef.h>
+#include "sample_format.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static const sample_format_t g_formats[SAMPLE_FORMAT_NUM_FORMATS] = {
+    { SAMPLE_FORMAT_CI16, sizeof(complex_sample_t), 16, 0, "ci16" },
+    { SAMPLE_FORMAT_CI32, 2*sizeof(int),            32, 0, "ci32" },
+    { SAMPLE_FORMAT_CF32, 2*sizeof(float),          32, 1, "cf32" },
+};
+
+static short sat_16(long long x) {
+    if (x > 32767) {
+        return 32767;
+    } else if (x < -32768) {
+        return -32768;
+    }
+    return (short)x;
+}
+
+static int sat_32(long long x) {
+    if (x > 2147483647LL) {
+        return 2147483647;
+    } else if (x < -2147483648LL) {
+        return (int)(-2147483647 - 1);
+    }
+    return (int)x;
+}
+
+const sample_format_t* sample_format_get(sample_format_id_t id) {
+    if ((id < 0) || (id >= SAMPLE_FORMAT_NUM_FORMATS)) {
+        return NULL;
+    }
+    return &g_formats[id];
+}
+
+int sample_format_bytes(sample_format_id_t id) {
+    const sample_format_t* p_fmt = sample_format_get(id);
+    return (p_fmt == NULL) ? 0 : p_fmt->sample_bytes;
+}
+
+// the kernels below work on re and im alike, so they treat a buffer as a flat
+// array of 2*num_samples components and do 8 per iteration
+void sample_format_cf32_to_ci16(complex_sample_t* dst, const float* src, int num_samples, float scale) {
+    short* p_dst = (short*)dst;
+    int    n     = 2*num_samples;
+    int    i     = 0;
+
+#ifdef __ARM_NEON
+    float32x4_t v_scale = vdupq_n_f32(scale);
+    float32x4_t v_max   = vdupq_n_f32(32767.0f);
+    float32x4_t v_min   = vdupq_n_f32(-32768.0f);
+    float32x4_t v_zero  = vdupq_n_f32(0.0f);
+    float32x4_t v_pos   = vdupq_n_f32(0.5f);
+    float32x4_t v_neg   = vdupq_n_f32(-0.5f);
+
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vmulq_f32(vld1q_f32(&src[i]),     v_scale);
+        float32x4_t b = vmulq_f32(vld1q_f32(&src[i + 4]), v_scale);
+
+        // clamp first, then round half away from zero, the conversion truncates
+        a = vminq_f32(vmaxq_f32(a, v_min), v_max);
+        b = vminq_f32(vmaxq_f32(b, v_min), v_max);
+        a = vaddq_f32(a, vbslq_f32(vcltq_f32(a, v_zero), v_neg, v_pos));
+        b = vaddq_f32(b, vbslq_f32(vcltq_f32(b, v_zero), v_neg, v_pos));
+
+        vst1q_s16(&p_dst[i], vcombine_s16(vqmovn_s32(vcvtq_s32_f32(a)), vqmovn_s32(vcvtq_s32_f32(b))));
+    }
+#elif defined(__SSE2__)
+    __m128 v_scale = _mm_set1_ps(scale);
+    __m128 v_max   = _mm_set1_ps(32767.0f);
+    __m128 v_min   = _mm_set1_ps(-32768.0f);
+    __m128 v_sign  = _mm_set1_ps(-0.0f);
+    __m128 v_half  = _mm_set1_ps(0.5f);
+
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(&src[i]),     v_scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(&src[i + 4]), v_scale);
+
+        // out of range converts to 0x80000000 whatever the sign, so clamp first.
+        // Then round half away from zero like the other paths: add 0.5 with the
+        // sign of the value and truncate, cvtps would round half to even
+        a = _mm_min_ps(_mm_max_ps(a, v_min), v_max);
+        b = _mm_min_ps(_mm_max_ps(b, v_min), v_max);
+        a = _mm_add_ps(a, _mm_or_ps(_mm_and_ps(a, v_sign), v_half));
+        b = _mm_add_ps(b, _mm_or_ps(_mm_and_ps(b, v_sign), v_half));
+
+        _mm_storeu_si128((__m128i*)&p_dst[i], _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+    }
+#endif
+
+    for (; i < n; i++) {
+        float v = src[i] * scale;
+        if (v > 32767.0f) {
+            v = 32767.0f;
+        } else if (v < -32768.0f) {
+            v = -32768.0f;
+        }
+        p_dst[i] = (short)((v < 0.0f) ? (v - 0.5f) : (v + 0.5f));
+    }
+}
+
+void sample_format_ci16_to_cf32(float* dst, const complex_sample_t* src, int num_samples, float scale) {
+    const short* p_src = (const short*)src;
+    int          n     = 2*num_samples;
+    int          i     = 0;
+
+#ifdef __ARM_NEON
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t x = vld1q_s16(&p_src[i]);
+
+        vst1q_f32(&dst[i],     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))),  scale));
+        vst1q_f32(&dst[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), scale));
+    }
+#elif defined(__SSE2__)
+    __m128 v_scale = _mm_set1_ps(scale);
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i x  = _mm_loadu_si128((const __m128i*)&p_src[i]);
+        // widen with sign by placing each short in the top half and shifting down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+
+        _mm_storeu_ps(&dst[i],     _mm_mul_ps(_mm_cvtepi32_ps(lo), v_scale));
+        _mm_storeu_ps(&dst[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), v_scale));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = (float)p_src[i] * scale;
+    }
+}
+
+int sample_format_ci32_block_exp(const int* src, int num_samples) {
+    int          n    = 2*num_samples;
+    int          i    = 0;
+    unsigned int bits = 0;
+
+    // or together x ^ (x >> 31), which has the same bit length as the magnitude
+    // for either sign. The widest component sets the exponent
+#ifdef __ARM_NEON
+    int32x4_t acc = vdupq_n_s32(0);
+    for (; i + 8 <= n; i += 8) {
+        int32x4_t a = vld1q_s32(&src[i]);
+        int32x4_t b = vld1q_s32(&src[i + 4]);
+        acc = vorrq_s32(acc, veorq_s32(a, vshrq_n_s32(a, 31)));
+        acc = vorrq_s32(acc, veorq_s32(b, vshrq_n_s32(b, 31)));
+    }
+    bits = vgetq_lane_s32(acc, 0) | vgetq_lane_s32(acc, 1) | vgetq_lane_s32(acc, 2) | vgetq_lane_s32(acc, 3);
+#elif defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)&src[i]);
+        __m128i b = _mm_loadu_si128((const __m128i*)&src[i + 4]);
+        acc = _mm_or_si128(acc, _mm_xor_si128(a, _mm_srai_epi32(a, 31)));
+        acc = _mm_or_si128(acc, _mm_xor_si128(b, _mm_srai_epi32(b, 31)));
+    }
+    acc  = _mm_or_si128(acc, _mm_srli_si128(acc, 8));
+    acc  = _mm_or_si128(acc, _mm_srli_si128(acc, 4));
+    bits = _mm_cvtsi128_si32(acc);
+#endif
+
+    for (; i < n; i++) {
+        bits |= src[i] ^ (src[i] >> 31);
+    }
+
+    int width = (bits == 0) ? 0 : 32 - __builtin_clz(bits);
+    return (width > 15) ? (width - 15) : 0;
+}
+
+void sample_format_ci32_to_ci16(complex_sample_t* dst, const int* src, int num_samples, int block_exp) {
+    short* p_dst = (short*)dst;
+    int    n     = 2*num_samples;
+    int    i     = 0;
+
+#ifdef __ARM_NEON
+    // vrshl by a negative amount is a rounding right shift, with no intermediate overflow
+    int32x4_t v_shift = vdupq_n_s32(-block_exp);
+
+    for (; i + 8 <= n; i += 8) {
+        int32x4_t a = vrshlq_s32(vld1q_s32(&src[i]),     v_shift);
+        int32x4_t b = vrshlq_s32(vld1q_s32(&src[i + 4]), v_shift);
+
+        vst1q_s16(&p_dst[i], vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+#elif defined(__SSE2__)
+    if (block_exp > 0) {
+        // (x >> e) + bit e-1 of x rounds without the overflow of adding half first
+        __m128i v_shift = _mm_cvtsi32_si128(block_exp);
+        __m128i v_half  = _mm_cvtsi32_si128(block_exp - 1);
+        __m128i v_one   = _mm_set1_epi32(1);
+
+        for (; i + 8 <= n; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*)&src[i]);
+            __m128i b = _mm_loadu_si128((const __m128i*)&src[i + 4]);
+
+            a = _mm_add_epi32(_mm_sra_epi32(a, v_shift), _mm_and_si128(_mm_sra_epi32(a, v_half), v_one));
+            b = _mm_add_epi32(_mm_sra_epi32(b, v_shift), _mm_and_si128(_mm_sra_epi32(b, v_half), v_one));
+
+            _mm_storeu_si128((__m128i*)&p_dst[i], _mm_packs_epi32(a, b));
+        }
+    } else {
+        for (; i + 8 <= n; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*)&src[i]);
+            __m128i b = _mm_loadu_si128((const __m128i*)&src[i + 4]);
+
+            _mm_storeu_si128((__m128i*)&p_dst[i], _mm_packs_epi32(a, b));
+        }
+    }
+#endif
+
+    for (; i < n; i++) {
+        long long v = src[i];
+        if (block_exp > 0) {
+            v = (v >> block_exp) + ((v >> (block_exp - 1)) & 1);
+        }
+        p_dst[i] = sat_16(v);
+    }
+}
+
+void sample_format_ci16_to_ci32(int* dst, const complex_sample_t* src, int num_samples, int shift) {
+    const short* p_src = (const short*)src;
+    int          n     = 2*num_samples;
+    int          i     = 0;
+
+#ifdef __ARM_NEON
+    int32x4_t v_shift = vdupq_n_s32(shift);
+
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t x = vld1q_s16(&p_src[i]);
+
+        vst1q_s32(&dst[i],     vqshlq_s32(vmovl_s16(vget_low_s16(x)),  v_shift));
+        vst1q_s32(&dst[i + 4], vqshlq_s32(vmovl_s16(vget_high_s16(x)), v_shift));
+    }
+#elif defined(__SSE2__)
+    // a 16-bit value shifted by up to 16 always fits, past that saturate in the scalar loop
+    if (shift <= 16) {
+        __m128i v_shift = _mm_cvtsi32_si128(shift);
+
+        for (; i + 8 <= n; i += 8) {
+            __m128i x  = _mm_loadu_si128((const __m128i*)&p_src[i]);
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+
+            _mm_storeu_si128((__m128i*)&dst[i],     _mm_sll_epi32(lo, v_shift));
+            _mm_storeu_si128((__m128i*)&dst[i + 4], _mm_sll_epi32(hi, v_shift));
+        }
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = sat_32((long long)p_src[i] << shift);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef SAMPLE_FORMAT_H
+#define SAMPLE_FORMAT_H
+
+#include "complex_sample.h"
+
+typedef enum
+{
+    SAMPLE_FORMAT_CI16 = 0,  // complex_sample_t, what the fft core streams
+    SAMPLE_FORMAT_CI32 = 1,  // two ints, also carries sign-extended 24-bit data
+    SAMPLE_FORMAT_CF32 = 2,  // two floats
+    SAMPLE_FORMAT_NUM_FORMATS
+} sample_format_id_t;
+
+typedef struct sample_format
+{
+    sample_format_id_t id;
+    int                sample_bytes;    // one complex sample
+    int                component_bits;  // one of re or im
+    int                is_float;
+    const char*        name;
+} sample_format_t;
+
+// descriptor of a format, NULL for an unknown id
+const sample_format_t* sample_format_get(sample_format_id_t id);
+
+int sample_format_bytes(sample_format_id_t id);
+
+// dst = saturate(round(src * scale))
+void sample_format_cf32_to_ci16(complex_sample_t* dst, const float* src, int num_samples, float scale);
+
+// dst = src * scale
+void sample_format_ci16_to_cf32(float* dst, const complex_sample_t* src, int num_samples, float scale);
+
+// smallest right shift that brings every component of src into 16 bits
+int sample_format_ci32_block_exp(const int* src, int num_samples);
+
+// dst = saturate(round(src >> block_exp))
+void sample_format_ci32_to_ci16(complex_sample_t* dst, const int* src, int num_samples, int block_exp);
+
+// dst = saturate(src << shift)
+void sample_format_ci16_to_ci32(int* dst, const complex_sample_t* src, int num_samples, int shift);
+
+#endif // SAMPLE_FORMAT_H
@@ -0,0 +1,530 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "xil_printf.h"
+#include "sdft.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+// bins are processed this many at a time, the bin arrays are padded to it
+#define SDFT_LANES      4
+
+// samples converted per pass, bounds the scratch buffers
+#define SDFT_CHUNK      64
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct sdft {
+    fft_t*            p_fft_inst;
+    int               num_pts;
+    sdft_mode_t       mode;
+    int               num_bins;
+    int               num_lanes;       // num_bins rounded up to SDFT_LANES
+    int*              bins;
+    float             damping;
+    float             damping_N;       // weight of the sample leaving the window
+
+    // per lane, num_lanes entries each
+    float*            p_re;            // current bin values
+    float*            p_im;
+    float*            p_cos;           // cos and sin of the bin frequency
+    float*            p_sin;
+    float*            p_c_re;          // sliding twiddle, damping * e^(jw)
+    float*            p_c_im;
+    float*            p_coef;          // goertzel, 2cos(w)
+    float*            p_s1_re;         // goertzel state s[n-1] and s[n-2]
+    float*            p_s1_im;
+    float*            p_s2_re;
+    float*            p_s2_im;
+
+    complex_sample_t* p_hist;          // last num_pts samples, oldest at hist_pos
+    int               hist_pos;
+    int               win_pos;         // goertzel, samples into the current window
+
+    complex_sample_t* p_frame;         // engine frame for seeding and re-syncs
+    int               resync_interval;
+    int               since_resync;
+    int               resync_pending;
+    int               resync_age;      // samples pushed since the re-sync frame was taken
+    float*            p_snap_re;       // bin values when the re-sync frame was taken
+    float*            p_snap_im;
+    int               num_resyncs;
+    float             last_drift;
+
+    sdft_update_fn    update_fn;
+    void*             p_ctx;
+
+    float             x_re[SDFT_CHUNK];
+    float             x_im[SDFT_CHUNK];
+} sdft_t;
+
+static float* alloc_lanes(int num_lanes) {
+    return (float*) calloc(num_lanes, sizeof(float));
+}
+
+static void update_twiddles(sdft_t* p_sdft_inst) {
+    for (int b = 0; b < p_sdft_inst->num_lanes; b++) {
+        p_sdft_inst->p_c_re[b] = p_sdft_inst->damping * p_sdft_inst->p_cos[b];
+        p_sdft_inst->p_c_im[b] = p_sdft_inst->damping * p_sdft_inst->p_sin[b];
+    }
+    p_sdft_inst->damping_N = powf(p_sdft_inst->damping, (float)p_sdft_inst->num_pts);
+}
+
+// S = damping * e^(jw) * (S + d) for every bin, once per entry of d
+static void slide_bins(sdft_t* p_sdft_inst, const float* d_re, const float* d_im, int n) {
+    for (int b = 0; b < p_sdft_inst->num_lanes; b += SDFT_LANES) {
+#ifdef __ARM_NEON
+        float32x4_t s_re = vld1q_f32(&p_sdft_inst->p_re[b]);
+        float32x4_t s_im = vld1q_f32(&p_sdft_inst->p_im[b]);
+        float32x4_t c_re = vld1q_f32(&p_sdft_inst->p_c_re[b]);
+        float32x4_t c_im = vld1q_f32(&p_sdft_inst->p_c_im[b]);
+
+        for (int i = 0; i < n; i++) {
+            float32x4_t a_re = vaddq_f32(s_re, vdupq_n_f32(d_re[i]));
+            float32x4_t a_im = vaddq_f32(s_im, vdupq_n_f32(d_im[i]));
+
+            s_re = vmlsq_f32(vmulq_f32(a_re, c_re), a_im, c_im);
+            s_im = vmlaq_f32(vmulq_f32(a_re, c_im), a_im, c_re);
+        }
+
+        vst1q_f32(&p_sdft_inst->p_re[b], s_re);
+        vst1q_f32(&p_sdft_inst->p_im[b], s_im);
+#else
+        for (int l = b; l < b + SDFT_LANES; l++) {
+            float s_re = p_sdft_inst->p_re[l];
+            float s_im = p_sdft_inst->p_im[l];
+            float c_re = p_sdft_inst->p_c_re[l];
+            float c_im = p_sdft_inst->p_c_im[l];
+
+            for (int i = 0; i < n; i++) {
+                float a_re = s_re + d_re[i];
+                float a_im = s_im + d_im[i];
+
+                s_re = a_re*c_re - a_im*c_im;
+                s_im = a_re*c_im + a_im*c_re;
+            }
+
+            p_sdft_inst->p_re[l] = s_re;
+            p_sdft_inst->p_im[l] = s_im;
+        }
+#endif
+    }
+}
+
+// s[n] = x[n] + 2cos(w) s[n-1] - s[n-2] for every bin
+static void goertzel_bins(sdft_t* p_sdft_inst, const float* x_re, const float* x_im, int n) {
+    for (int b = 0; b < p_sdft_inst->num_lanes; b += SDFT_LANES) {
+#ifdef __ARM_NEON
+        float32x4_t s1_re = vld1q_f32(&p_sdft_inst->p_s1_re[b]);
+        float32x4_t s1_im = vld1q_f32(&p_sdft_inst->p_s1_im[b]);
+        float32x4_t s2_re = vld1q_f32(&p_sdft_inst->p_s2_re[b]);
+        float32x4_t s2_im = vld1q_f32(&p_sdft_inst->p_s2_im[b]);
+        float32x4_t coef  = vld1q_f32(&p_sdft_inst->p_coef[b]);
+
+        for (int i = 0; i < n; i++) {
+            float32x4_t s0_re = vsubq_f32(vmlaq_f32(vdupq_n_f32(x_re[i]), coef, s1_re), s2_re);
+            float32x4_t s0_im = vsubq_f32(vmlaq_f32(vdupq_n_f32(x_im[i]), coef, s1_im), s2_im);
+
+            s2_re = s1_re;
+            s2_im = s1_im;
+            s1_re = s0_re;
+            s1_im = s0_im;
+        }
+
+        vst1q_f32(&p_sdft_inst->p_s1_re[b], s1_re);
+        vst1q_f32(&p_sdft_inst->p_s1_im[b], s1_im);
+        vst1q_f32(&p_sdft_inst->p_s2_re[b], s2_re);
+        vst1q_f32(&p_sdft_inst->p_s2_im[b], s2_im);
+#else
+        for (int l = b; l < b + SDFT_LANES; l++) {
+            float s1_re = p_sdft_inst->p_s1_re[l];
+            float s1_im = p_sdft_inst->p_s1_im[l];
+            float s2_re = p_sdft_inst->p_s2_re[l];
+            float s2_im = p_sdft_inst->p_s2_im[l];
+            float coef  = p_sdft_inst->p_coef[l];
+
+            for (int i = 0; i < n; i++) {
+                float s0_re = x_re[i] + coef*s1_re - s2_re;
+                float s0_im = x_im[i] + coef*s1_im - s2_im;
+
+                s2_re = s1_re;
+                s2_im = s1_im;
+                s1_re = s0_re;
+                s1_im = s0_im;
+            }
+
+            p_sdft_inst->p_s1_re[l] = s1_re;
+            p_sdft_inst->p_s1_im[l] = s1_im;
+            p_sdft_inst->p_s2_re[l] = s2_re;
+            p_sdft_inst->p_s2_im[l] = s2_im;
+        }
+#endif
+    }
+}
+
+// one more step with x = 0, then X = s[N] - e^(-jw) s[N-1]. Starts the next window
+static void goertzel_finish(sdft_t* p_sdft_inst) {
+    for (int b = 0; b < p_sdft_inst->num_lanes; b++) {
+        float s1_re = p_sdft_inst->p_s1_re[b];
+        float s1_im = p_sdft_inst->p_s1_im[b];
+        float s0_re = p_sdft_inst->p_coef[b]*s1_re - p_sdft_inst->p_s2_re[b];
+        float s0_im = p_sdft_inst->p_coef[b]*s1_im - p_sdft_inst->p_s2_im[b];
+
+        p_sdft_inst->p_re[b] = s0_re - (p_sdft_inst->p_cos[b]*s1_re + p_sdft_inst->p_sin[b]*s1_im);
+        p_sdft_inst->p_im[b] = s0_im - (p_sdft_inst->p_cos[b]*s1_im - p_sdft_inst->p_sin[b]*s1_re);
+
+        p_sdft_inst->p_s1_re[b] = 0.0f;
+        p_sdft_inst->p_s1_im[b] = 0.0f;
+        p_sdft_inst->p_s2_re[b] = 0.0f;
+        p_sdft_inst->p_s2_im[b] = 0.0f;
+    }
+}
+
+// the engine always runs forward transforms of the window size for us
+static int prepare_engine(sdft_t* p_sdft_inst) {
+    if (fft_ensure_config(p_sdft_inst->p_fft_inst, p_sdft_inst->num_pts, FFT_FORWARD) != FFT_SUCCESS) {
+        return SDFT_FFT_FAIL;
+    }
+    return SDFT_SUCCESS;
+}
+
+// history ring into the engine frame, oldest sample first
+static void copy_window(sdft_t* p_sdft_inst) {
+    int tail = p_sdft_inst->num_pts - p_sdft_inst->hist_pos;
+
+    memcpy(p_sdft_inst->p_frame, &p_sdft_inst->p_hist[p_sdft_inst->hist_pos], sizeof(complex_sample_t)*tail);
+    memcpy(&p_sdft_inst->p_frame[tail], p_sdft_inst->p_hist, sizeof(complex_sample_t)*p_sdft_inst->hist_pos);
+}
+
+// tracked bin j of the transformed frame, undoing the scale schedule
+static void frame_bin(sdft_t* p_sdft_inst, int j, float* p_re, float* p_im) {
+    int              shift = fft_get_scale_shift(p_sdft_inst->p_fft_inst);
+    complex_sample_t X     = p_sdft_inst->p_frame[p_sdft_inst->bins[j]];
+
+    *p_re = ldexpf((float)X.data_re, shift);
+    *p_im = ldexpf((float)X.data_im, shift);
+}
+
+static int start_resync(sdft_t* p_sdft_inst) {
+    if (prepare_engine(p_sdft_inst) != SDFT_SUCCESS) {
+        return SDFT_FFT_FAIL;
+    }
+    copy_window(p_sdft_inst);
+
+    int status = fft_start(p_sdft_inst->p_fft_inst, p_sdft_inst->p_frame, p_sdft_inst->p_frame);
+    if (status == FFT_BUSY) {
+        // someone else has the engine, try again after the next chunk
+        return SDFT_SUCCESS;
+    } else if (status != FFT_SUCCESS) {
+        return SDFT_FFT_FAIL;
+    }
+
+    memcpy(p_sdft_inst->p_snap_re, p_sdft_inst->p_re, sizeof(float)*p_sdft_inst->num_lanes);
+    memcpy(p_sdft_inst->p_snap_im, p_sdft_inst->p_im, sizeof(float)*p_sdft_inst->num_lanes);
+    p_sdft_inst->resync_pending = 1;
+    p_sdft_inst->resync_age     = 0;
+    p_sdft_inst->since_resync   = 0;
+
+    return SDFT_SUCCESS;
+}
+
+// the recursion is linear, so the error it had when the frame was taken has since
+// been rotated and damped by (damping * e^(jw))^age. Remove exactly that
+static int poll_resync(sdft_t* p_sdft_inst) {
+    int status = fft_poll(p_sdft_inst->p_fft_inst);
+    if (status == FFT_BUSY) {
+        return SDFT_SUCCESS;
+    }
+
+    p_sdft_inst->resync_pending = 0;
+    if (status != FFT_SUCCESS) {
+        return SDFT_FFT_FAIL;
+    }
+
+    float decay = powf(p_sdft_inst->damping, (float)p_sdft_inst->resync_age);
+    float drift = 0.0f;
+
+    for (int j = 0; j < p_sdft_inst->num_bins; j++) {
+        float hw_re, hw_im;
+        frame_bin(p_sdft_inst, j, &hw_re, &hw_im);
+
+        float err_re = hw_re - p_sdft_inst->p_snap_re[j];
+        float err_im = hw_im - p_sdft_inst->p_snap_im[j];
+
+        // reduce k*age mod N first so the angle stays exact for long delays
+        long long turns = ((long long)p_sdft_inst->bins[j] * p_sdft_inst->resync_age) % p_sdft_inst->num_pts;
+        float     angle = (float)(2.0*M_PI*(double)turns / p_sdft_inst->num_pts);
+        float     rot_re = decay*cosf(angle);
+        float     rot_im = decay*sinf(angle);
+
+        p_sdft_inst->p_re[j] += err_re*rot_re - err_im*rot_im;
+        p_sdft_inst->p_im[j] += err_re*rot_im + err_im*rot_re;
+
+        float mag = sqrtf(err_re*err_re + err_im*err_im);
+        if (mag > drift) {
+            drift = mag;
+        }
+    }
+
+    p_sdft_inst->last_drift = drift;
+    p_sdft_inst->num_resyncs++;
+
+    return SDFT_SUCCESS;
+}
+
+static int push_sliding(sdft_t* p_sdft_inst, const complex_sample_t* din, int n) {
+    // d = x[n] - damping^N x[n-N], the same for every bin
+    for (int i = 0; i < n; i++) {
+        complex_sample_t old = p_sdft_inst->p_hist[p_sdft_inst->hist_pos];
+
+        p_sdft_inst->x_re[i] = (float)din[i].data_re - p_sdft_inst->damping_N*(float)old.data_re;
+        p_sdft_inst->x_im[i] = (float)din[i].data_im - p_sdft_inst->damping_N*(float)old.data_im;
+
+        p_sdft_inst->p_hist[p_sdft_inst->hist_pos] = din[i];
+        p_sdft_inst->hist_pos = (p_sdft_inst->hist_pos + 1) % p_sdft_inst->num_pts;
+    }
+
+    if (p_sdft_inst->update_fn == NULL) {
+        // bins stay in registers across the whole chunk
+        slide_bins(p_sdft_inst, p_sdft_inst->x_re, p_sdft_inst->x_im, n);
+    } else {
+        for (int i = 0; i < n; i++) {
+            slide_bins(p_sdft_inst, &p_sdft_inst->x_re[i], &p_sdft_inst->x_im[i], 1);
+            p_sdft_inst->update_fn(p_sdft_inst->p_re, p_sdft_inst->p_im, p_sdft_inst->num_bins, p_sdft_inst->p_ctx);
+        }
+    }
+
+    p_sdft_inst->since_resync += n;
+    if (p_sdft_inst->resync_pending) {
+        p_sdft_inst->resync_age += n;
+        return poll_resync(p_sdft_inst);
+    } else if ((p_sdft_inst->resync_interval > 0) && (p_sdft_inst->since_resync >= p_sdft_inst->resync_interval)) {
+        return start_resync(p_sdft_inst);
+    }
+
+    return SDFT_SUCCESS;
+}
+
+static void push_goertzel(sdft_t* p_sdft_inst, const complex_sample_t* din, int n) {
+    for (int i = 0; i < n; i++) {
+        p_sdft_inst->x_re[i] = (float)din[i].data_re;
+        p_sdft_inst->x_im[i] = (float)din[i].data_im;
+    }
+
+    goertzel_bins(p_sdft_inst, p_sdft_inst->x_re, p_sdft_inst->x_im, n);
+
+    p_sdft_inst->win_pos += n;
+    if (p_sdft_inst->win_pos == p_sdft_inst->num_pts) {
+        goertzel_finish(p_sdft_inst);
+        p_sdft_inst->win_pos = 0;
+        if (p_sdft_inst->update_fn != NULL) {
+            p_sdft_inst->update_fn(p_sdft_inst->p_re, p_sdft_inst->p_im, p_sdft_inst->num_bins, p_sdft_inst->p_ctx);
+        }
+    }
+}
+
+// Public functions
+sdft_t* sdft_create(fft_t* p_fft_inst, int num_pts, const int* bins, int num_bins, sdft_mode_t mode) {
+
+    if ((num_pts < 1) || (num_pts > FFT_MAX_NUM_PTS) || (bins == NULL) || (num_bins < 1) ||
+        ((mode != SDFT_MODE_SLIDING) && (mode != SDFT_MODE_GOERTZEL))) {
+        xil_printf("ERROR! Illegal sliding DFT parameters.\n\r");
+        return NULL;
+    }
+
+    for (int j = 0; j < num_bins; j++) {
+        if ((bins[j] < 0) || (bins[j] >= num_pts)) {
+            xil_printf("ERROR! Bin %d is out of range for a %d-point DFT.\n\r", bins[j], num_pts);
+            return NULL;
+        }
+    }
+
+    sdft_t* p_obj = (sdft_t*) calloc(1, sizeof(sdft_t));
+    if (p_obj == NULL) {
+        xil_printf("ERROR! Failed to allocate memory for sliding DFT object.\n\r");
+        return NULL;
+    }
+
+    p_obj->p_fft_inst = p_fft_inst;
+    p_obj->num_pts    = num_pts;
+    p_obj->mode       = mode;
+    p_obj->num_bins   = num_bins;
+    p_obj->num_lanes  = (num_bins + SDFT_LANES - 1) / SDFT_LANES * SDFT_LANES;
+    p_obj->damping    = SDFT_DEFAULT_DAMPING;
+
+    p_obj->bins      = (int*) malloc(sizeof(int)*num_bins);
+    p_obj->p_re      = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_im      = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_cos     = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_sin     = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_c_re    = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_c_im    = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_coef    = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_s1_re   = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_s1_im   = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_s2_re   = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_s2_im   = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_snap_re = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_snap_im = alloc_lanes(p_obj->num_lanes);
+    p_obj->p_hist    = (complex_sample_t*) calloc(num_pts, sizeof(complex_sample_t));
+    p_obj->p_frame   = (complex_sample_t*) dma_accel_alloc_buf(sizeof(complex_sample_t)*num_pts);
+
+    if ((p_obj->bins == NULL) || (p_obj->p_re == NULL) || (p_obj->p_im == NULL) || (p_obj->p_cos == NULL) ||
+        (p_obj->p_sin == NULL) || (p_obj->p_c_re == NULL) || (p_obj->p_c_im == NULL) || (p_obj->p_coef == NULL) ||
+        (p_obj->p_s1_re == NULL) || (p_obj->p_s1_im == NULL) || (p_obj->p_s2_re == NULL) || (p_obj->p_s2_im == NULL) ||
+        (p_obj->p_snap_re == NULL) || (p_obj->p_snap_im == NULL) || (p_obj->p_hist == NULL) || (p_obj->p_frame == NULL)) {
+        xil_printf("ERROR! Failed to allocate memory for sliding DFT buffers.\n\r");
+        sdft_destroy(p_obj);
+        return NULL;
+    }
+
+    // the range check above doesn't cover non powers of 2 or sizes this core can't run
+    if (fft_set_num_pts(p_fft_inst, num_pts) != FFT_SUCCESS) {
+        xil_printf("ERROR! The FFT engine can't run a %d-point transform for the sliding DFT.\n\r", num_pts);
+        sdft_destroy(p_obj);
+        return NULL;
+    }
+
+    // padding lanes track bin 0 and are never reported. These are the twiddles
+    // fft_tables caches, but the recursions run them once per sample and Q15
+    // costs two orders of magnitude in accuracy, so they're computed in float
+    memcpy(p_obj->bins, bins, sizeof(int)*num_bins);
+    for (int b = 0; b < p_obj->num_lanes; b++) {
+        double w = (b < num_bins) ? 2.0*M_PI*bins[b] / num_pts : 0.0;
+        p_obj->p_cos[b]  = (float)cos(w);
+        p_obj->p_sin[b]  = (float)sin(w);
+        p_obj->p_coef[b] = (float)(2.0*cos(w));
+    }
+    update_twiddles(p_obj);
+
+    return p_obj;
+
+}
+
+void sdft_destroy(sdft_t* p_sdft_inst) {
+    // don't free the frame under a running transform
+    if (p_sdft_inst->resync_pending) {
+        fft_wait(p_sdft_inst->p_fft_inst);
+    }
+
+    free(p_sdft_inst->bins);
+    free(p_sdft_inst->p_re);
+    free(p_sdft_inst->p_im);
+    free(p_sdft_inst->p_cos);
+    free(p_sdft_inst->p_sin);
+    free(p_sdft_inst->p_c_re);
+    free(p_sdft_inst->p_c_im);
+    free(p_sdft_inst->p_coef);
+    free(p_sdft_inst->p_s1_re);
+    free(p_sdft_inst->p_s1_im);
+    free(p_sdft_inst->p_s2_re);
+    free(p_sdft_inst->p_s2_im);
+    free(p_sdft_inst->p_snap_re);
+    free(p_sdft_inst->p_snap_im);
+    free(p_sdft_inst->p_hist);
+    dma_accel_free_buf(p_sdft_inst->p_frame);
+    free(p_sdft_inst);
+}
+
+int sdft_seed(sdft_t* p_sdft_inst, const complex_sample_t* din) {
+
+    if (p_sdft_inst->resync_pending) {
+        fft_wait(p_sdft_inst->p_fft_inst);
+        p_sdft_inst->resync_pending = 0;
+    }
+
+    memcpy(p_sdft_inst->p_hist, din, sizeof(complex_sample_t)*p_sdft_inst->num_pts);
+    p_sdft_inst->hist_pos     = 0;
+    p_sdft_inst->win_pos      = 0;
+    p_sdft_inst->since_resync = 0;
+
+    if (prepare_engine(p_sdft_inst) != SDFT_SUCCESS) {
+        xil_printf("ERROR! The FFT engine can't run a %d-point transform for the sliding DFT.\n\r", p_sdft_inst->num_pts);
+        return SDFT_FFT_FAIL;
+    }
+    copy_window(p_sdft_inst);
+    if (fft(p_sdft_inst->p_fft_inst, p_sdft_inst->p_frame, p_sdft_inst->p_frame) != FFT_SUCCESS) {
+        xil_printf("ERROR! Failed to seed the sliding DFT.\n\r");
+        return SDFT_FFT_FAIL;
+    }
+
+    for (int j = 0; j < p_sdft_inst->num_bins; j++) {
+        frame_bin(p_sdft_inst, j, &p_sdft_inst->p_re[j], &p_sdft_inst->p_im[j]);
+    }
+
+    int lane_bytes = sizeof(float)*p_sdft_inst->num_lanes;
+    memset(p_sdft_inst->p_s1_re, 0, lane_bytes);
+    memset(p_sdft_inst->p_s1_im, 0, lane_bytes);
+    memset(p_sdft_inst->p_s2_re, 0, lane_bytes);
+    memset(p_sdft_inst->p_s2_im, 0, lane_bytes);
+
+    return SDFT_SUCCESS;
+}
+
+void sdft_set_resync_interval(sdft_t* p_sdft_inst, int num_samples) {
+    p_sdft_inst->resync_interval = (num_samples > 0) ? num_samples : 0;
+}
+
+void sdft_set_damping(sdft_t* p_sdft_inst, float damping) {
+    p_sdft_inst->damping = damping;
+    update_twiddles(p_sdft_inst);
+}
+
+void sdft_set_update_fn(sdft_t* p_sdft_inst, sdft_update_fn update_fn, void* p_ctx) {
+    p_sdft_inst->update_fn = update_fn;
+    p_sdft_inst->p_ctx     = p_ctx;
+}
+
+int sdft_push(sdft_t* p_sdft_inst, const complex_sample_t* din, int num_samples) {
+
+    int done = 0;
+
+    while (done < num_samples) {
+        int n = num_samples - done;
+        if (n > SDFT_CHUNK) {
+            n = SDFT_CHUNK;
+        }
+
+        if (p_sdft_inst->mode == SDFT_MODE_SLIDING) {
+            // stop at the re-sync point so the frame holds exactly the current window
+            if ((p_sdft_inst->resync_interval > 0) && !p_sdft_inst->resync_pending) {
+                int until_resync = p_sdft_inst->resync_interval - p_sdft_inst->since_resync;
+                if ((until_resync > 0) && (n > until_resync)) {
+                    n = until_resync;
+                }
+            }
+
+            int status = push_sliding(p_sdft_inst, &din[done], n);
+            if (status != SDFT_SUCCESS) {
+                xil_printf("ERROR! Sliding DFT re-sync failed.\n\r");
+                return status;
+            }
+        } else {
+            if (n > p_sdft_inst->num_pts - p_sdft_inst->win_pos) {
+                n = p_sdft_inst->num_pts - p_sdft_inst->win_pos;
+            }
+
+            push_goertzel(p_sdft_inst, &din[done], n);
+        }
+
+        done += n;
+    }
+
+    return SDFT_SUCCESS;
+}
+
+void sdft_get_bins(sdft_t* p_sdft_inst, float* p_re, float* p_im) {
+    memcpy(p_re, p_sdft_inst->p_re, sizeof(float)*p_sdft_inst->num_bins);
+    memcpy(p_im, p_sdft_inst->p_im, sizeof(float)*p_sdft_inst->num_bins);
+}
+
+int sdft_get_num_resyncs(sdft_t* p_sdft_inst) {
+    return (p_sdft_inst->num_resyncs);
+}
+
+float sdft_get_last_drift(sdft_t* p_sdft_inst) {
+    return (p_sdft_inst->last_drift);
+}
@@ -0,0 +1,64 @@
+#ifndef SDFT_H
+#define SDFT_H
+
+#include "complex_sample.h"
+#include "fft.h"
+
+#define SDFT_SUCCESS           0
+#define SDFT_ILLEGAL_PARAMS   -1
+#define SDFT_ALLOC_FAIL       -2
+#define SDFT_FFT_FAIL         -3
+
+// damping of the sliding recursion. Pulls its poles just inside the unit circle
+// so float rounding decays instead of accumulating
+#define SDFT_DEFAULT_DAMPING   0.999999f
+
+typedef enum
+{
+    // every bin is updated on every sample, O(num_bins) per sample
+    SDFT_MODE_SLIDING  = 0,
+    // bins are computed over consecutive num_pts sample windows and updated once
+    // per window. Cheaper per sample and never drifts, for sparse bin sets that
+    // don't need per-sample output
+    SDFT_MODE_GOERTZEL = 1
+} sdft_mode_t;
+
+typedef struct sdft sdft_t;
+
+// called after every update with the current value of each tracked bin, in the
+// order the bins were given to sdft_create
+typedef void (*sdft_update_fn)(const float* p_re, const float* p_im, int num_bins, void* p_ctx);
+
+// track bins[0 .. num_bins-1] of a num_pts-point forward DFT over a sliding window.
+// Values are unnormalised, on the same scale as the engine output shifted back up
+// by its scale schedule. p_fft_inst seeds and re-syncs the sliding state
+sdft_t* sdft_create(fft_t* p_fft_inst, int num_pts, const int* bins, int num_bins, sdft_mode_t mode);
+
+void sdft_destroy(sdft_t* p_sdft_inst);
+
+// load a full window (num_pts samples, oldest first) and take the bin values from
+// one engine transform of it
+int sdft_seed(sdft_t* p_sdft_inst, const complex_sample_t* din);
+
+// in sliding mode, re-run the window through the engine every num_samples samples
+// and fold the difference into the tracked bins to bound drift. 0 disables.
+// The engine must not be used for anything else while a re-sync is in flight
+void sdft_set_resync_interval(sdft_t* p_sdft_inst, int num_samples);
+
+void sdft_set_damping(sdft_t* p_sdft_inst, float damping);
+
+void sdft_set_update_fn(sdft_t* p_sdft_inst, sdft_update_fn update_fn, void* p_ctx);
+
+// feed new samples. Calls the update function per sample (sliding) or per window
+// (goertzel) if one is set
+int sdft_push(sdft_t* p_sdft_inst, const complex_sample_t* din, int num_samples);
+
+// latest value of every tracked bin
+void sdft_get_bins(sdft_t* p_sdft_inst, float* p_re, float* p_im);
+
+int sdft_get_num_resyncs(sdft_t* p_sdft_inst);
+
+// largest correction applied to any bin by the last re-sync
+float sdft_get_last_drift(sdft_t* p_sdft_inst);
+
+#endif // SDFT_H
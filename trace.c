@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <string.h>
+#include "trace.h"
+
+#ifdef __linux__
+#include <time.h>
+#define TRACE_TICKS_PER_SEC 1000000000U
+#else
+#include "xtime_l.h"
+#include "xuartps_hw.h"
+#define TRACE_TICKS_PER_SEC COUNTS_PER_SECOND
+#endif
+
+static trace_event_t g_trace_events[TRACE_MAX_EVENTS];
+static uint32_t      g_trace_next    = 0;
+static uint32_t      g_trace_dropped = 0;
+static volatile int  g_trace_enabled = 0;
+
+static const char* const g_trace_names[TRACE_EV_COUNT] = {
+    "commit_params",
+    "cache_flush",
+    "cache_invalidate",
+    "mm2s_submit",
+    "s2mm_submit",
+    "mm2s_xfer",
+    "s2mm_xfer",
+    "mm2s_isr",
+    "s2mm_isr",
+    "wait",
+    "user"
+};
+
+static const char* const g_track_names[] = {"cpu", "isr", "dma mm2s", "dma s2mm"};
+
+static uint64_t now_ticks(void) {
+#ifdef __linux__
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+#else
+    XTime now;
+    XTime_GetTime(&now);
+    return now;
+#endif
+}
+
+void trace_start(void) {
+    g_trace_enabled = 0;
+    g_trace_next    = 0;
+    g_trace_dropped = 0;
+    g_trace_enabled = 1;
+}
+
+void trace_stop(void) {
+    g_trace_enabled = 0;
+}
+
+void trace_record(trace_event_id_t id, int phase, trace_track_t track, uint32_t arg) {
+
+    if (!g_trace_enabled) {
+        return;
+    }
+
+    // claim a slot. The atomic add keeps interrupt and thread context apart
+    uint32_t slot = __atomic_fetch_add(&g_trace_next, 1, __ATOMIC_RELAXED);
+    if (slot >= TRACE_MAX_EVENTS) {
+        __atomic_fetch_add(&g_trace_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    trace_event_t* p_event = &g_trace_events[slot];
+    p_event->timestamp = now_ticks();
+    p_event->id        = (uint16_t)id;
+    p_event->phase     = (uint8_t)phase;
+    p_event->track     = (uint8_t)track;
+    p_event->arg       = arg;
+
+}
+
+int trace_num_events(void) {
+    uint32_t n = __atomic_load_n(&g_trace_next, __ATOMIC_RELAXED);
+    return (n > TRACE_MAX_EVENTS) ? TRACE_MAX_EVENTS : (int)n;
+}
+
+int trace_dump(trace_write_fn write, void* p_ctx) {
+
+    trace_dump_header_t header;
+
+    header.magic         = TRACE_MAGIC;
+    header.ticks_per_sec = TRACE_TICKS_PER_SEC;
+    header.num_events    = trace_num_events();
+    header.num_dropped   = g_trace_dropped;
+
+    if (write(p_ctx, &header, sizeof(header)) != 0) {
+        return TRACE_BAD_DUMP;
+    }
+    if (write(p_ctx, g_trace_events, header.num_events*sizeof(trace_event_t)) != 0) {
+        return TRACE_BAD_DUMP;
+    }
+
+    return TRACE_SUCCESS;
+
+}
+
+static int write_str(trace_write_fn write, void* p_ctx, const char* str) {
+    return write(p_ctx, str, (int)strlen(str));
+}
+
+static int write_json(const trace_event_t* p_events, uint32_t num_events, uint32_t ticks_per_sec,
+                      trace_write_fn write, void* p_ctx) {
+
+    char     line[192];
+    uint64_t t0 = (num_events > 0) ? p_events[0].timestamp : 0;
+
+    // slots are claimed in order, so the first event is the earliest up to isr preemption
+    for (uint32_t i = 0; i < num_events; i++) {
+        if (p_events[i].timestamp < t0) {
+            t0 = p_events[i].timestamp;
+        }
+    }
+
+    if (write_str(write, p_ctx, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n") != 0) {
+        return TRACE_BAD_DUMP;
+    }
+
+    // name the tracks
+    for (int track = 0; track < 4; track++) {
+        snprintf(line, sizeof(line),
+                 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}%s\n",
+                 track, g_track_names[track], ((track < 3 || num_events > 0) ? "," : ""));
+        if (write_str(write, p_ctx, line) != 0) {
+            return TRACE_BAD_DUMP;
+        }
+    }
+
+    for (uint32_t i = 0; i < num_events; i++) {
+        const trace_event_t* p_event = &p_events[i];
+        uint64_t             ticks   = p_event->timestamp - t0;
+        // microseconds with ns resolution, without relying on float printf. Whole
+        // seconds are split off first so ticks*1e9 can't overflow on long traces
+        uint64_t             ns      = (ticks/ticks_per_sec)*1000000000ULL +
+                                       ((ticks%ticks_per_sec)*1000000000ULL)/ticks_per_sec;
+        const char*          name    = (p_event->id < TRACE_EV_COUNT) ? g_trace_names[p_event->id] : "unknown";
+
+        snprintf(line, sizeof(line),
+                 "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":0,\"tid\":%u,%s\"args\":{\"id\":%lu}}%s\n",
+                 name, p_event->phase, (unsigned long long)(ns/1000), (unsigned int)(ns%1000), p_event->track,
+                 (p_event->phase == TRACE_PHASE_INSTANT ? "\"s\":\"t\"," : ""),
+                 (unsigned long)p_event->arg, (i + 1 < num_events ? "," : ""));
+        if (write_str(write, p_ctx, line) != 0) {
+            return TRACE_BAD_DUMP;
+        }
+    }
+
+    if (write_str(write, p_ctx, "]}\n") != 0) {
+        return TRACE_BAD_DUMP;
+    }
+
+    return TRACE_SUCCESS;
+
+}
+
+int trace_export_json(trace_write_fn write, void* p_ctx) {
+    return write_json(g_trace_events, trace_num_events(), TRACE_TICKS_PER_SEC, write, p_ctx);
+}
+
+int trace_dump_to_json(const void* p_dump, int dump_bytes, trace_write_fn write, void* p_ctx) {
+
+    trace_dump_header_t header;
+
+    if (dump_bytes < (int)sizeof(header)) {
+        return TRACE_BAD_DUMP;
+    }
+    memcpy(&header, p_dump, sizeof(header));
+
+    if ((header.magic != TRACE_MAGIC) || (header.ticks_per_sec == 0) ||
+        (dump_bytes < (int)(sizeof(header) + header.num_events*sizeof(trace_event_t)))) {
+        return TRACE_BAD_DUMP;
+    }
+
+    return write_json((const trace_event_t*)((const char*)p_dump + sizeof(header)), header.num_events,
+                      header.ticks_per_sec, write, p_ctx);
+
+}
+
+#ifndef __linux__
+static int uart_write(void* p_ctx, const void* p_data, int num_bytes) {
+    uint32_t       base  = *(uint32_t*)p_ctx;
+    const uint8_t* bytes = (const uint8_t*)p_data;
+
+    for (int i = 0; i < num_bytes; i++) {
+        XUartPs_SendByte(base, bytes[i]);
+    }
+    return 0;
+}
+
+int trace_dump_uart(uint32_t uart_base_addr) {
+    return trace_dump(uart_write, &uart_base_addr);
+}
+#endif
@@ -0,0 +1,103 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// Low overhead timeline recorder. Events go into a preallocated binary buffer
+// and can be dumped as-is (e.g. over the UART) or converted to Chrome trace /
+// Perfetto JSON. Recording compiles away unless TRACE_ENABLE is defined.
+
+#define TRACE_SUCCESS        0
+#define TRACE_BAD_DUMP      -1
+
+#define TRACE_MAX_EVENTS     8192
+#define TRACE_MAGIC          0x31435254 // "TRC1"
+
+// what happened
+typedef enum
+{
+    TRACE_EV_COMMIT_PARAMS = 0,
+    TRACE_EV_CACHE_FLUSH,
+    TRACE_EV_CACHE_INVALIDATE,
+    TRACE_EV_MM2S_SUBMIT,
+    TRACE_EV_S2MM_SUBMIT,
+    TRACE_EV_MM2S_XFER,        // dma channel busy, submit to completion
+    TRACE_EV_S2MM_XFER,
+    TRACE_EV_MM2S_ISR,
+    TRACE_EV_S2MM_ISR,
+    TRACE_EV_WAIT,
+    TRACE_EV_USER,             // application post-processing
+    TRACE_EV_COUNT
+} trace_event_id_t;
+
+// timeline row an event is drawn on
+typedef enum
+{
+    TRACE_TRACK_CPU  = 0,
+    TRACE_TRACK_ISR  = 1,
+    TRACE_TRACK_MM2S = 2,
+    TRACE_TRACK_S2MM = 3
+} trace_track_t;
+
+#define TRACE_PHASE_BEGIN    'B'
+#define TRACE_PHASE_END      'E'
+#define TRACE_PHASE_INSTANT  'i'
+
+// 16 bytes, stored and dumped little-endian
+typedef struct trace_event
+{
+    uint64_t timestamp;
+    uint16_t id;
+    uint8_t  phase;
+    uint8_t  track;
+    uint32_t arg;
+} trace_event_t;
+
+// header in front of a binary dump
+typedef struct trace_dump_header
+{
+    uint32_t magic;
+    uint32_t ticks_per_sec;
+    uint32_t num_events;
+    uint32_t num_dropped;
+} trace_dump_header_t;
+
+// sink for dumps and json, returns 0 on success
+typedef int (*trace_write_fn)(void* p_ctx, const void* p_data, int num_bytes);
+
+// forget everything recorded so far and start recording
+void trace_start(void);
+
+// stop recording, the buffer is kept for dumping
+void trace_stop(void);
+
+// record one event. Safe to call from interrupt context. Drops the event once the buffer is full
+void trace_record(trace_event_id_t id, int phase, trace_track_t track, uint32_t arg);
+
+int trace_num_events(void);
+
+// binary dump: header followed by the raw events
+int trace_dump(trace_write_fn write, void* p_ctx);
+
+// Chrome trace / Perfetto JSON of the recorded events
+int trace_export_json(trace_write_fn write, void* p_ctx);
+
+// Chrome trace / Perfetto JSON of a binary dump, e.g. one captured from the board
+int trace_dump_to_json(const void* p_dump, int dump_bytes, trace_write_fn write, void* p_ctx);
+
+#ifndef __linux__
+// binary dump over a PS7 UART
+int trace_dump_uart(uint32_t uart_base_addr);
+#endif
+
+#ifdef TRACE_ENABLE
+#define TRACE_BEGIN(id, track, arg)   trace_record((id), TRACE_PHASE_BEGIN, (track), (uint32_t)(arg))
+#define TRACE_END(id, track, arg)     trace_record((id), TRACE_PHASE_END, (track), (uint32_t)(arg))
+#define TRACE_INSTANT(id, track, arg) trace_record((id), TRACE_PHASE_INSTANT, (track), (uint32_t)(arg))
+#else
+#define TRACE_BEGIN(id, track, arg)   do { } while (0)
+#define TRACE_END(id, track, arg)     do { } while (0)
+#define TRACE_INSTANT(id, track, arg) do { } while (0)
+#endif
+
+#endif // TRACE_H
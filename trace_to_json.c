@@ -0,0 +1,60 @@
+#ifdef __linux__
+
+// Host tool: converts a binary trace dump captured from the board's UART into
+// Chrome trace / Perfetto JSON.
+//
+//   gcc -O2 -o trace_to_json trace_to_json.c trace.c
+//   ./trace_to_json dump.bin > trace.json
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "trace.h"
+
+static int file_write(void* p_ctx, const void* p_data, int num_bytes) {
+    return (fwrite(p_data, 1, num_bytes, (FILE*)p_ctx) == (size_t)num_bytes) ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s dump.bin [out.json]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(argv[1], "rb");
+    if (in == NULL) {
+        perror("ERROR! fopen");
+        return 1;
+    }
+    fseek(in, 0, SEEK_END);
+    long num_bytes = ftell(in);
+    fseek(in, 0, SEEK_SET);
+
+    char* p_dump = (char*) malloc(num_bytes);
+    if ((p_dump == NULL) || (fread(p_dump, 1, num_bytes, in) != (size_t)num_bytes)) {
+        fprintf(stderr, "ERROR! Failed to read %s\n", argv[1]);
+        return 1;
+    }
+    fclose(in);
+
+    FILE* out = (argc > 2) ? fopen(argv[2], "w") : stdout;
+    if (out == NULL) {
+        perror("ERROR! fopen");
+        return 1;
+    }
+
+    int status = trace_dump_to_json(p_dump, (int)num_bytes, file_write, out);
+    if (status != TRACE_SUCCESS) {
+        fprintf(stderr, "ERROR! %s is not a trace dump\n", argv[1]);
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(p_dump);
+
+    return (status == TRACE_SUCCESS) ? 0 : 1;
+
+}
+
+#endif // __linux__